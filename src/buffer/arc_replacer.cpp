@@ -0,0 +1,170 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// arc_replacer.cpp
+//
+// Identification: src/buffer/arc_replacer.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/arc_replacer.h"
+
+#include <algorithm>
+
+namespace bustub {
+
+ARCReplacer::ARCReplacer(size_t num_pages)
+    : capacity_(num_pages), lists_(num_pages, FrameList::NONE), last_reference_(num_pages), evictable_(num_pages) {}
+
+ARCReplacer::~ARCReplacer() = default;
+
+bool ARCReplacer::Victim(frame_id_t *frame_id) {
+  std::scoped_lock lock(latch_);
+  bool from_t1 = !t1_.empty() && (t1_size_ > target_ || t2_.empty());
+  auto &frames = from_t1 ? t1_ : t2_;
+  if (frames.empty()) {
+    return false;
+  }
+  *frame_id = frames.begin()->second;
+  frames.erase(frames.begin());
+  evictable_[*frame_id] = false;
+  // The frame stays in its list until ReplacePage tells which page it held, it may also be handed back unevicted.
+  return true;
+}
+
+void ARCReplacer::Pin(frame_id_t frame_id) {
+  std::scoped_lock lock(latch_);
+  BUSTUB_ASSERT(frame_id >= 0 && static_cast<size_t>(frame_id) < evictable_.size(), "Frame id out of range.");
+  if (lists_[frame_id] == FrameList::NONE) {
+    Link(frame_id, FrameList::T1);
+    return;
+  }
+  if (!evictable_[frame_id]) {
+    return;
+  }
+  // A new reference to an unpinned frame, which moves it to the frequency list.
+  Unlink(frame_id);
+  if (lists_[frame_id] == FrameList::T1) {
+    t1_size_--;
+    t2_size_++;
+    lists_[frame_id] = FrameList::T2;
+  }
+  last_reference_[frame_id] = ++current_timestamp_;
+}
+
+void ARCReplacer::Unpin(frame_id_t frame_id) {
+  std::scoped_lock lock(latch_);
+  BUSTUB_ASSERT(frame_id >= 0 && static_cast<size_t>(frame_id) < evictable_.size(), "Frame id out of range.");
+  if (lists_[frame_id] == FrameList::NONE) {
+    Link(frame_id, FrameList::T1);
+  }
+  if (evictable_[frame_id]) {
+    return;
+  }
+  Evictable(lists_[frame_id]).emplace(last_reference_[frame_id], frame_id);
+  evictable_[frame_id] = true;
+}
+
+bool ARCReplacer::Remove(frame_id_t frame_id) {
+  std::scoped_lock lock(latch_);
+  BUSTUB_ASSERT(frame_id >= 0 && static_cast<size_t>(frame_id) < evictable_.size(), "Frame id out of range.");
+  if (!evictable_[frame_id]) {
+    return false;
+  }
+  Unlink(frame_id);
+  return true;
+}
+
+size_t ARCReplacer::Size() {
+  std::scoped_lock lock(latch_);
+  return t1_.size() + t2_.size();
+}
+
+void ARCReplacer::ReplacePage(frame_id_t frame_id, page_id_t old_page_id, page_id_t page_id) {
+  std::scoped_lock lock(latch_);
+  BUSTUB_ASSERT(frame_id >= 0 && static_cast<size_t>(frame_id) < evictable_.size(), "Frame id out of range.");
+  if (evictable_[frame_id]) {
+    Unlink(frame_id);
+  }
+  if (lists_[frame_id] == FrameList::T1) {
+    t1_size_--;
+    if (old_page_id != INVALID_PAGE_ID) {
+      b1_.Push(old_page_id);
+    }
+  } else if (lists_[frame_id] == FrameList::T2) {
+    t2_size_--;
+    if (old_page_id != INVALID_PAGE_ID) {
+      b2_.Push(old_page_id);
+    }
+  }
+  lists_[frame_id] = FrameList::NONE;
+
+  if (page_id != INVALID_PAGE_ID) {
+    // A page evicted from T1 too early grows T1, a page evicted from T2 too early grows T2.
+    if (b1_.Erase(page_id)) {
+      target_ = std::min(capacity_, target_ + std::max<size_t>(1, b2_.Size() / (b1_.Size() + 1)));
+      Link(frame_id, FrameList::T2);
+    } else if (b2_.Erase(page_id)) {
+      size_t delta = std::max<size_t>(1, b1_.Size() / (b2_.Size() + 1));
+      target_ = target_ > delta ? target_ - delta : 0;
+      Link(frame_id, FrameList::T2);
+    } else {
+      Link(frame_id, FrameList::T1);
+    }
+  }
+  TrimGhosts();
+}
+
+size_t ARCReplacer::GetRecencyTarget() {
+  std::scoped_lock lock(latch_);
+  return target_;
+}
+
+void ARCReplacer::Link(frame_id_t frame_id, FrameList list) {
+  lists_[frame_id] = list;
+  if (list == FrameList::T1) {
+    t1_size_++;
+  } else {
+    t2_size_++;
+  }
+  last_reference_[frame_id] = ++current_timestamp_;
+}
+
+void ARCReplacer::Unlink(frame_id_t frame_id) {
+  Evictable(lists_[frame_id]).erase({last_reference_[frame_id], frame_id});
+  evictable_[frame_id] = false;
+}
+
+void ARCReplacer::TrimGhosts() {
+  while (b1_.Size() > 0 && t1_size_ + b1_.Size() > capacity_) {
+    b1_.Pop();
+  }
+  while (b2_.Size() > 0 && t1_size_ + t2_size_ + b1_.Size() + b2_.Size() > 2 * capacity_) {
+    b2_.Pop();
+  }
+}
+
+void ARCReplacer::GhostList::Push(page_id_t page_id) {
+  pages_.push_front(page_id);
+  positions_[page_id] = pages_.begin();
+}
+
+bool ARCReplacer::GhostList::Erase(page_id_t page_id) {
+  auto it = positions_.find(page_id);
+  if (it == positions_.end()) {
+    return false;
+  }
+  pages_.erase(it->second);
+  positions_.erase(it);
+  return true;
+}
+
+void ARCReplacer::GhostList::Pop() {
+  positions_.erase(pages_.back());
+  pages_.pop_back();
+}
+
+}  // namespace bustub
@@ -12,127 +12,953 @@
 
 #include "buffer/buffer_pool_manager.h"
 
+#include <algorithm>
+#include <chrono>  // NOLINT
 #include <list>
+#include <sstream>
 #include <unordered_map>
+#include <utility>
 
 namespace bustub {
 
-BufferPoolManager::BufferPoolManager(size_t pool_size, DiskManager *disk_manager, LogManager *log_manager)
-    : pool_size_(pool_size), disk_manager_(disk_manager), log_manager_(log_manager) {
-  // We allocate a consecutive memory space for the buffer pool.
-  pages_ = new Page[pool_size_];
-  replacer_ = new LRUReplacer(pool_size);
+namespace {
+
+std::unique_ptr<Replacer> MakeReplacer(BufferPoolManager::ReplacerType replacer_type, size_t num_frames) {
+  switch (replacer_type) {
+    case BufferPoolManager::ReplacerType::LRU:
+      break;
+    case BufferPoolManager::ReplacerType::CLOCK:
+      return std::make_unique<ClockReplacer>(num_frames);
+    case BufferPoolManager::ReplacerType::LRU_K:
+      return std::make_unique<LRUKReplacer>(num_frames);
+    case BufferPoolManager::ReplacerType::ARC:
+      return std::make_unique<ARCReplacer>(num_frames);
+  }
+  return std::make_unique<LRUReplacer>(num_frames);
+}
+
+}  // namespace
+
+BufferPoolManager::BufferPoolInstance::BufferPoolInstance(size_t index, size_t num_frames, ReplacerType replacer_type)
+    : index_(index), num_frames_(num_frames), replacer_type_(replacer_type), page_table_(num_frames) {
+  replacer_ = MakeReplacer(replacer_type_, num_frames_);
+  AddFrames(num_frames_);
+  // Initially, every frame of the instance is in the free list.
+  for (size_t i = 0; i < num_frames_; ++i) {
+    free_list_.emplace_back(static_cast<frame_id_t>(i));
+  }
+}
+
+BufferPoolManager::BufferPoolInstance::FrameChunk::FrameChunk(size_t first_frame_id, size_t num_frames)
+    : first_frame_id_(first_frame_id),
+      num_frames_(num_frames),
+      arena_(num_frames),
+      frames_(std::make_unique<Frame[]>(num_frames)) {
+  for (size_t i = 0; i < num_frames_; ++i) {
+    frames_[i].frame_id_ = static_cast<frame_id_t>(first_frame_id_ + i);
+    frames_[i].arena_data_ = arena_.GetFrameData(i);
+    frames_[i].page_.data_ = frames_[i].arena_data_;
+  }
+}
+
+void BufferPoolManager::BufferPoolInstance::AddFrames(size_t num_frames) {
+  size_t capacity = chunks_.empty() ? 0 : chunks_.back()->first_frame_id_ + chunks_.back()->num_frames_;
+  if (capacity < num_frames) {
+    chunks_.emplace_back(std::make_unique<FrameChunk>(capacity, num_frames - capacity));
+  }
+  for (auto &chunk : chunks_) {
+    for (size_t i = frames_.size() - std::min(frames_.size(), chunk->first_frame_id_);
+         i < chunk->num_frames_ && frames_.size() < num_frames; ++i) {
+      frames_.push_back(&chunk->frames_[i]);
+    }
+  }
+}
+
+void BufferPoolManager::BufferPoolInstance::RemoveFrames(size_t num_frames) {
+  for (auto &chunk : chunks_) {
+    size_t end = chunk->first_frame_id_ + chunk->num_frames_;
+    size_t first = std::max(chunk->first_frame_id_, num_frames);
+    if (first < end && first < frames_.size()) {
+      chunk->arena_.Release(first - chunk->first_frame_id_, std::min(end, frames_.size()) - first);
+    }
+  }
+  frames_.resize(num_frames);
+}
+
+BufferPoolManager::BufferPoolManager(size_t pool_size, DiskManager *disk_manager, LogManager *log_manager,
+                                     ReplacerType replacer_type)
+    : BufferPoolManager(pool_size, 1, disk_manager, log_manager, replacer_type) {}
 
-  // Initially, every page is in the free list.
-  for (size_t i = 0; i < pool_size_; ++i) {
-    free_list_.emplace_back(static_cast<int>(i));
+BufferPoolManager::BufferPoolManager(size_t pool_size, size_t num_instances, DiskManager *disk_manager,
+                                     LogManager *log_manager, ReplacerType replacer_type)
+    : pool_size_(pool_size), disk_manager_(disk_manager), log_manager_(log_manager) {
+  BUSTUB_ASSERT(num_instances > 0, "A buffer pool needs at least one instance.");
+  // The first (pool_size % num_instances) instances get one extra frame.
+  for (size_t i = 0; i < num_instances; ++i) {
+    size_t num_frames = pool_size / num_instances + (i < pool_size % num_instances ? 1 : 0);
+    instances_.emplace_back(new BufferPoolInstance(i, num_frames, replacer_type));
   }
 }
 
 BufferPoolManager::~BufferPoolManager() {
-  delete[] pages_;
-  delete replacer_;
+  StopPrefetchThread();
+  StopBackgroundFlushThread();
 }
 
-Page *BufferPoolManager::FetchPageImpl(page_id_t page_id) {
-  std::scoped_lock lock(latch_);
+std::vector<Page *> BufferPoolManager::GetPages() {
+  std::vector<Page *> pages;
+  for (auto &instance : instances_) {
+    std::scoped_lock lock(instance->latch_);
+    for (auto &frame : instance->frames_) {
+      pages.push_back(&frame->page_);
+    }
+  }
+  return pages;
+}
 
-  if (page_table_.count(page_id) != 0) {
-    frame_id_t frame_id = page_table_[page_id];
-    replacer_->Pin(frame_id);
-    pages_[frame_id].pin_count_++;
-    return &pages_[frame_id];
+void BufferPoolManager::Resize(size_t pool_size) {
+  BUSTUB_ASSERT(pool_size >= instances_.size(), "A buffer pool needs at least one frame per instance.");
+  std::scoped_lock resize_lock(resize_latch_);
+  for (size_t i = 0; i < instances_.size(); ++i) {
+    ResizeInstance(instances_[i].get(), pool_size / instances_.size() + (i < pool_size % instances_.size() ? 1 : 0));
   }
+  pool_size_ = pool_size;
+}
+
+void BufferPoolManager::ResizeInstance(BufferPoolInstance *instance, size_t num_frames) {
+  std::unique_lock lock(instance->latch_);
+  if (num_frames >= instance->frames_.size()) {
+    for (size_t i = instance->frames_.size(); i < num_frames; ++i) {
+      instance->free_list_.emplace_back(static_cast<frame_id_t>(i));
+    }
+    instance->AddFrames(num_frames);
+    instance->num_frames_ = num_frames;
+    RebuildReplacer(instance);
+    return;
+  }
+
+  // From now on, the removed frames are neither handed out nor unpinned into the replacer.
+  instance->num_frames_ = num_frames;
+  instance->free_list_.remove_if([instance](frame_id_t frame_id) { return !instance->IsActive(frame_id); });
+  RebuildReplacer(instance);
 
+  // Evict the pages of the removed frames as they become unpinned.
+  while (true) {
+    bool drained = true;
+    for (size_t i = num_frames; i < instance->frames_.size(); ++i) {
+      BufferPoolInstance::Frame &frame = *instance->frames_[i];
+      Page &page = frame.page_;
+      // A frame taken from the free list before the resize may still be loading its first page.
+      if (frame.in_io_ || instance->flushing_pages_.count(page.page_id_) != 0) {
+        drained = false;
+        continue;
+      }
+      if (page.page_id_ == INVALID_PAGE_ID) {
+        continue;
+      }
+      if (!ClaimFrame(&frame)) {
+        drained = false;
+        continue;
+      }
+      page_id_t page_id = page.page_id_;
+      BufferPoolCounters::Increment(&instance->counters_.evictions_);
+      if (page.is_dirty_) {
+        // Fetchers of the page wait for the write-back, then read the page into another frame.
+        frame.in_io_ = true;
+        lock.unlock();
+        disk_manager_->WritePage(page_id, page.data_);
+        num_foreground_writes_++;
+        BufferPoolCounters::Increment(&instance->counters_.dirty_write_backs_);
+        lock.lock();
+      }
+      instance->page_table_.Erase(page_id);
+      page.page_id_ = INVALID_PAGE_ID;
+      page.is_dirty_ = false;
+      frame.in_io_ = false;
+      page.pin_count_ = 0;
+      frame.io_done_.notify_all();
+    }
+    if (drained) {
+      break;
+    }
+    lock.unlock();
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    lock.lock();
+  }
+  instance->RemoveFrames(num_frames);
+}
+
+void BufferPoolManager::RebuildReplacer(BufferPoolInstance *instance) {
+  std::unique_ptr<Replacer> replacer = MakeReplacer(instance->replacer_type_, instance->num_frames_);
   frame_id_t frame_id;
-  if (!free_list_.empty()) {
-    frame_id = free_list_.front();
-    free_list_.pop_front();
+  while (instance->replacer_->Victim(&frame_id)) {
+    if (instance->IsActive(frame_id)) {
+      replacer->Unpin(frame_id);
+    }
+  }
+  instance->replacer_ = std::move(replacer);
+}
+
+BufferPoolStats BufferPoolManager::GetStats() {
+  BufferPoolStats stats;
+  for (auto &instance : instances_) {
+    stats += instance->counters_.Snapshot();
+  }
+  return stats;
+}
+
+void BufferPoolManager::ResetStats() {
+  for (auto &instance : instances_) {
+    instance->counters_.Reset();
+  }
+}
+
+std::vector<std::pair<page_id_t, int>> BufferPoolManager::GetPinnedPages() {
+  std::vector<std::pair<page_id_t, int>> pinned_pages;
+  for (auto &instance : instances_) {
+    std::scoped_lock lock(instance->latch_);
+    // Frames being drained by a resize are included, their pins are the ones a shrink waits for.
+    for (auto &frame : instance->frames_) {
+      int pin_count = frame->page_.pin_count_;
+      page_id_t page_id = frame->page_.page_id_;
+      if (pin_count > 0 && page_id != INVALID_PAGE_ID) {
+        pinned_pages.emplace_back(page_id, pin_count);
+      }
+    }
+  }
+  std::sort(pinned_pages.begin(), pinned_pages.end());
+  return pinned_pages;
+}
+
+std::string BufferPoolManager::DumpPinnedPages() {
+  std::ostringstream os;
+  for (const auto &[page_id, pin_count] : GetPinnedPages()) {
+    os << "page " << page_id << ": " << pin_count << " pins\n";
+  }
+  return os.str();
+}
+
+void BufferPoolManager::RunBackgroundFlushThread(size_t clean_frames) {
+  std::scoped_lock lock(flush_thread_latch_);
+  if (flush_thread_ != nullptr) {
+    return;
+  }
+  flush_thread_running_ = true;
+  flush_thread_ = std::make_unique<std::thread>([this, clean_frames] {
+    std::unique_lock flush_lock(flush_thread_latch_);
+    while (!flush_thread_cv_.wait_for(flush_lock, bgwriter_interval, [this] { return !flush_thread_running_; })) {
+      flush_lock.unlock();
+      for (auto &instance : instances_) {
+        BackgroundFlush(instance.get(), clean_frames);
+      }
+      flush_lock.lock();
+    }
+  });
+}
+
+void BufferPoolManager::StopBackgroundFlushThread() {
+  {
+    std::scoped_lock lock(flush_thread_latch_);
+    if (flush_thread_ == nullptr) {
+      return;
+    }
+    flush_thread_running_ = false;
+  }
+  flush_thread_cv_.notify_all();
+  flush_thread_->join();
+  flush_thread_.reset();
+}
+
+bool BufferPoolManager::FindFreeFrame(BufferPoolInstance *instance, frame_id_t *frame_id,
+                                      BufferAccessStrategy *strategy) {
+  std::unique_lock<std::mutex> ring_lock;
+  if (strategy != nullptr) {
+    ring_lock = std::unique_lock(strategy->latch_);
+    if (RecycleRingFrame(instance, frame_id, strategy)) {
+      return true;
+    }
+  }
+
+  if (!instance->free_list_.empty()) {
+    *frame_id = instance->free_list_.front();
+    instance->free_list_.pop_front();
+    // Only a lookup that raced with the eviction of the frame's last page can pin a free frame, and it lets go at once.
+    while (!ClaimFrame(instance->frames_[*frame_id])) {
+      std::this_thread::yield();
+    }
   } else {
-    if (!replacer_->Victim(&frame_id)) {
+    RecordPendingAccesses(instance);
+    do {
+      if (!instance->replacer_->Victim(frame_id)) {
+        return false;
+      }
+    } while (!ClaimOrSkipFrame(instance->frames_[*frame_id]));
+  }
+
+  // The frame joins the ring, replacing the frame the ring could not recycle.
+  if (strategy != nullptr) {
+    strategy->ring_[strategy->current_] = {instance->index_, *frame_id};
+    strategy->current_ = (strategy->current_ + 1) % strategy->ring_.size();
+  }
+  return true;
+}
+
+bool BufferPoolManager::RecycleRingFrame(BufferPoolInstance *instance, frame_id_t *frame_id,
+                                         BufferAccessStrategy *strategy) {
+  std::vector<BufferAccessStrategy::RingFrame> &ring = strategy->ring_;
+  // Fill the ring before recycling anything.
+  if (ring[strategy->current_].frame_id_ == BufferAccessStrategy::INVALID_FRAME_ID) {
+    return false;
+  }
+  // Other instances' frames, frames removed by a resize or frames someone else has pinned in the meantime are skipped.
+  for (size_t i = 0; i < ring.size(); ++i) {
+    size_t slot = (strategy->current_ + i) % ring.size();
+    frame_id_t candidate = ring[slot].frame_id_;
+    if (ring[slot].instance_ != instance->index_ || candidate == BufferAccessStrategy::INVALID_FRAME_ID ||
+        !instance->IsActive(candidate) || !instance->replacer_->Remove(candidate) ||
+        !ClaimOrSkipFrame(instance->frames_[candidate])) {
+      continue;
+    }
+    strategy->current_ = (slot + 1) % ring.size();
+    *frame_id = candidate;
+    return true;
+  }
+  return false;
+}
+
+Page *BufferPoolManager::LoadFrame(BufferPoolInstance *instance, std::unique_lock<std::mutex> *lock,
+                                   frame_id_t frame_id, page_id_t page_id, bool read, bool pin) {
+  Page &page = instance->GetPage(frame_id);
+  page_id_t old_page_id = StartLoad(instance, lock, frame_id, page_id);
+  if (!SetFrameData(instance, frame_id, page_id, read)) {
+    if (read && !disk_manager_->ReadPage(page_id, page.data_)) {
+      AbortLoad(instance, lock, frame_id, old_page_id, page_id);
       return nullptr;
     }
-    if (pages_[frame_id].is_dirty_) {
-      disk_manager_->WritePage(pages_[frame_id].page_id_, pages_[frame_id].data_);
+    if (!read) {
+      page.ResetMemory();
     }
-    page_table_.erase(pages_[frame_id].page_id_);
   }
+  // A new page is zeroed in memory only, the disk may still hold a deleted page under the same id.
+  return FinishLoad(instance, lock, frame_id, old_page_id, page_id, pin, !read);
+}
+
+bool BufferPoolManager::SetFrameData(BufferPoolInstance *instance, frame_id_t frame_id, page_id_t page_id,
+                                     bool read) {
+  BufferPoolInstance::Frame &frame = *instance->frames_[frame_id];
+  // Zero copy: the page is read-only, and the mapping outlives the buffer pool.
+  const char *mapped_data = read ? disk_manager_->GetMappedPage(page_id) : nullptr;
+  frame.page_.data_ = mapped_data != nullptr ? const_cast<char *>(mapped_data) : frame.arena_data_;
+  return mapped_data != nullptr;
+}
+
+page_id_t BufferPoolManager::StartLoad(BufferPoolInstance *instance, std::unique_lock<std::mutex> *lock,
+                                       frame_id_t frame_id, page_id_t page_id) {
+  BufferPoolInstance::Frame &frame = *instance->frames_[frame_id];
+  Page &page = frame.page_;
+  page_id_t old_page_id = page.page_id_;
+
+  // Nobody can pin the old page or the new one while the frame is claimed, so its data is ours until it completes.
+  frame.in_io_ = true;
+  instance->page_table_.Insert(page_id, &frame);
+  // A flush still writing a copy of either page must land before the write-back or the read.
+  instance->flush_done_.wait(*lock, [instance, old_page_id, page_id] {
+    return instance->flushing_pages_.count(old_page_id) == 0 && instance->flushing_pages_.count(page_id) == 0;
+  });
+  bool write_back = old_page_id != INVALID_PAGE_ID && page.is_dirty_;
+  lock->unlock();
 
-  page_table_[page_id] = frame_id;
-  Page &page = pages_[frame_id];
+  if (old_page_id != INVALID_PAGE_ID) {
+    BufferPoolCounters::Increment(&instance->counters_.evictions_);
+  }
+  if (write_back) {
+    disk_manager_->WritePage(old_page_id, page.data_);
+    num_foreground_writes_++;
+    BufferPoolCounters::Increment(&instance->counters_.dirty_write_backs_);
+  }
+  return old_page_id;
+}
+
+Page *BufferPoolManager::FinishLoad(BufferPoolInstance *instance, std::unique_lock<std::mutex> *lock,
+                                    frame_id_t frame_id, page_id_t old_page_id, page_id_t page_id, bool pin,
+                                    bool dirty) {
+  lock->lock();
+  BufferPoolInstance::Frame &frame = *instance->frames_[frame_id];
+  Page &page = frame.page_;
+  if (old_page_id != INVALID_PAGE_ID) {
+    instance->page_table_.Erase(old_page_id);
+  }
   page.page_id_ = page_id;
-  page.pin_count_ = 1;
+  page.is_dirty_ = dirty;
+  // A frame removed by a resize in the meantime stays out of the replacer, the resize evicts its page.
+  if (instance->IsActive(frame_id)) {
+    instance->replacer_->ReplacePage(frame_id, old_page_id, page_id);
+    if (pin) {
+      instance->replacer_->Pin(frame_id);
+    } else {
+      instance->replacer_->Unpin(frame_id);
+    }
+  }
+  frame.out_of_replacer_ = pin;
+  frame.in_io_ = false;
+  page.pin_count_ = pin ? 1 : 0;
+  frame.io_done_.notify_all();
+  return &page;
+}
+
+void BufferPoolManager::AbortLoad(BufferPoolInstance *instance, std::unique_lock<std::mutex> *lock,
+                                  frame_id_t frame_id, page_id_t old_page_id, page_id_t page_id) {
+  lock->lock();
+  BufferPoolInstance::Frame &frame = *instance->frames_[frame_id];
+  Page &page = frame.page_;
+  if (old_page_id != INVALID_PAGE_ID) {
+    instance->page_table_.Erase(old_page_id);
+  }
+  instance->page_table_.Erase(page_id);
+  page.page_id_ = INVALID_PAGE_ID;
   page.is_dirty_ = false;
-  disk_manager_->ReadPage(page_id, page.data_);
-  replacer_->Pin(frame_id);
+  // The old page is evicted all the same, the frame goes back to the free list empty.
+  if (instance->IsActive(frame_id)) {
+    instance->replacer_->ReplacePage(frame_id, old_page_id, INVALID_PAGE_ID);
+    instance->free_list_.emplace_back(frame_id);
+  }
+  frame.out_of_replacer_ = false;
+  frame.in_io_ = false;
+  page.pin_count_ = 0;
+  frame.io_done_.notify_all();
+}
+
+Page *BufferPoolManager::FetchPageImpl(page_id_t page_id, BufferAccessStrategy *strategy) {
+  BufferPoolInstance *instance = GetInstance(page_id);
+  size_t access_type = static_cast<size_t>(strategy != nullptr ? AccessType::STRATEGY : AccessType::SHARED);
+  Page *page = TryPinHit(instance, page_id);
+  if (page != nullptr) {
+    BufferPoolCounters::Increment(&instance->counters_.hits_[access_type]);
+    return page;
+  }
+  std::unique_lock lock(instance->latch_);
+
+  BufferPoolInstance::Frame *frame = instance->page_table_.Find(page_id);
+  // The frame holding the page is being loaded or written back, wait for it and look the page up again.
+  if (frame != nullptr && frame->in_io_) {
+    BufferPoolCounters::Increment(&instance->counters_.pin_waits_);
+  }
+  while (frame != nullptr && frame->in_io_) {
+    frame->io_done_.wait(lock);
+    frame = instance->page_table_.Find(page_id);
+  }
+  if (frame != nullptr) {
+    BufferPoolCounters::Increment(&instance->counters_.hits_[access_type]);
+    return PinFrame(instance, frame->frame_id_);
+  }
+
+  frame_id_t frame_id;
+  if (!FindFreeFrame(instance, &frame_id, strategy)) {
+    BufferPoolCounters::Increment(&instance->counters_.all_pinned_failures_);
+    return nullptr;
+  }
+  BufferPoolCounters::Increment(&instance->counters_.misses_[access_type]);
+  return LoadFrame(instance, &lock, frame_id, page_id, true, true);
+}
+
+Page *BufferPoolManager::TryPinHit(BufferPoolInstance *instance, page_id_t page_id) {
+  BufferPoolInstance::Frame *frame = instance->page_table_.Find(page_id);
+  if (frame == nullptr) {
+    return nullptr;
+  }
+  Page &page = frame->page_;
+  int pin_count = page.pin_count_.load();
+  do {
+    if (pin_count == CLAIMED) {
+      return nullptr;
+    }
+  } while (!page.pin_count_.compare_exchange_weak(pin_count, pin_count + 1));
+  // The frame cannot change pages while it is pinned, but it may have done so since the lookup.
+  if (page.page_id_ != page_id) {
+    ReleasePin(instance, frame, false);
+    return nullptr;
+  }
+  return &page;
+}
+
+bool BufferPoolManager::ReleasePin(BufferPoolInstance *instance, BufferPoolInstance::Frame *frame, bool is_dirty) {
+  Page &page = frame->page_;
+  // Mark the page before letting go of it, whoever evicts it afterwards writes it back.
+  if (is_dirty) {
+    page.is_dirty_ = true;
+  }
+  int pin_count = page.pin_count_.load();
+  do {
+    if (pin_count <= 0) {
+      return false;
+    }
+  } while (!page.pin_count_.compare_exchange_weak(pin_count, pin_count - 1));
+  if (pin_count > 1) {
+    return true;
+  }
+
+  std::unique_lock lock(instance->latch_, std::defer_lock);
+  bool out_of_replacer = frame->out_of_replacer_.exchange(false);
+  if (out_of_replacer) {
+    lock.lock();
+  } else if (!lock.try_lock()) {
+    // The frame is still in the replacer, whoever picks the next victim records the access.
+    if (!frame->access_pending_.exchange(true)) {
+      std::scoped_lock pending_lock(instance->pending_latch_);
+      instance->pending_accesses_.push_back(frame->frame_id_);
+    }
+    return true;
+  }
+  while (true) {
+    pin_count = page.pin_count_;
+    if (pin_count == 0 && page.page_id_ != INVALID_PAGE_ID && instance->IsActive(frame->frame_id_)) {
+      // Hits leave the replacer alone, pinning the frame now records the access and refreshes its position.
+      instance->replacer_->Pin(frame->frame_id_);
+      instance->replacer_->Unpin(frame->frame_id_);
+      return true;
+    }
+    // A free, removed or claimed frame must stay out of the replacer, a frame in the replacer stays there.
+    if (pin_count <= 0 || !out_of_replacer) {
+      return true;
+    }
+    // Pinned again by a hit, whose last unpin hands the frame back, unless that unpin already happened.
+    frame->out_of_replacer_ = true;
+    if (page.pin_count_ != 0 || !frame->out_of_replacer_.exchange(false)) {
+      return true;
+    }
+  }
+}
+
+void BufferPoolManager::RecordPendingAccesses(BufferPoolInstance *instance) {
+  std::vector<frame_id_t> frame_ids;
+  {
+    std::scoped_lock pending_lock(instance->pending_latch_);
+    frame_ids.swap(instance->pending_accesses_);
+  }
+  for (frame_id_t frame_id : frame_ids) {
+    if (static_cast<size_t>(frame_id) >= instance->frames_.size()) {
+      continue;
+    }
+    BufferPoolInstance::Frame &frame = *instance->frames_[frame_id];
+    frame.access_pending_ = false;
+    // A frame pinned again records its access at its last unpin.
+    if (frame.page_.pin_count_ == 0 && frame.page_.page_id_ != INVALID_PAGE_ID && instance->IsActive(frame_id)) {
+      instance->replacer_->Pin(frame_id);
+      instance->replacer_->Unpin(frame_id);
+    }
+  }
+}
+
+bool BufferPoolManager::ClaimFrame(BufferPoolInstance::Frame *frame) {
+  int pin_count = 0;
+  return frame->page_.pin_count_.compare_exchange_strong(pin_count, CLAIMED);
+}
+
+bool BufferPoolManager::ClaimOrSkipFrame(BufferPoolInstance::Frame *frame) {
+  if (ClaimFrame(frame)) {
+    return true;
+  }
+  // Pinned by a hit, whose last unpin hands the frame back, unless that unpin happened since.
+  frame->out_of_replacer_ = true;
+  if (ClaimFrame(frame)) {
+    frame->out_of_replacer_ = false;
+    return true;
+  }
+  return false;
+}
+
+Page *BufferPoolManager::PinFrame(BufferPoolInstance *instance, frame_id_t frame_id) {
+  Page &page = instance->GetPage(frame_id);
+  page.pin_count_++;
   return &page;
 }
 
+BasicPageGuard BufferPoolManager::FetchPageBasic(page_id_t page_id, BufferAccessStrategy *strategy) {
+  return {this, FetchPageImpl(page_id, strategy)};
+}
+
+ReadPageGuard BufferPoolManager::FetchPageRead(page_id_t page_id, BufferAccessStrategy *strategy) {
+  return FetchPageBasic(page_id, strategy).UpgradeRead();
+}
+
+WritePageGuard BufferPoolManager::FetchPageWrite(page_id_t page_id, BufferAccessStrategy *strategy) {
+  return FetchPageBasic(page_id, strategy).UpgradeWrite();
+}
+
+BasicPageGuard BufferPoolManager::NewPageGuarded(page_id_t *page_id, BufferAccessStrategy *strategy,
+                                                 ExtentAllocator *extent_allocator) {
+  return {this, NewPageImpl(page_id, strategy, extent_allocator)};
+}
+
+Page *BufferPoolManager::TryFetchPage(page_id_t page_id) {
+  BufferPoolInstance *instance = GetInstance(page_id);
+  auto *hits = &instance->counters_.hits_[static_cast<size_t>(AccessType::SHARED)];
+  Page *page = TryPinHit(instance, page_id);
+  if (page != nullptr) {
+    BufferPoolCounters::Increment(hits);
+    return page;
+  }
+  std::scoped_lock lock(instance->latch_);
+
+  BufferPoolInstance::Frame *frame = instance->page_table_.Find(page_id);
+  if (frame == nullptr || frame->in_io_) {
+    return nullptr;
+  }
+  BufferPoolCounters::Increment(hits);
+  return PinFrame(instance, frame->frame_id_);
+}
+
+void BufferPoolManager::PrefetchPage(page_id_t page_id, std::shared_ptr<BufferAccessStrategy> strategy) {
+  // Loading a page of a mapped database file takes no I/O, only the kernel has anything to read ahead.
+  if (disk_manager_->IsReadOnly()) {
+    disk_manager_->AdviseWillNeed(page_id, 1);
+    return;
+  }
+  {
+    std::scoped_lock lock(prefetch_latch_);
+    if (prefetch_queue_.size() >= PREFETCH_QUEUE_SIZE) {
+      return;
+    }
+    if (prefetch_thread_ == nullptr) {
+      prefetch_running_ = true;
+      prefetch_thread_ = std::make_unique<std::thread>(&BufferPoolManager::RunPrefetchThread, this);
+    }
+    prefetch_queue_.emplace_back(page_id, std::move(strategy));
+  }
+  prefetch_cv_.notify_one();
+}
+
+void BufferPoolManager::PrefetchPages(const std::vector<page_id_t> &page_ids,
+                                      std::shared_ptr<BufferAccessStrategy> strategy) {
+  for (page_id_t page_id : page_ids) {
+    PrefetchPage(page_id, strategy);
+  }
+}
+
+std::shared_ptr<BufferAccessStrategy> BufferPoolManager::NewScanStrategy() {
+  DiskManager *disk_manager = disk_manager_;
+  disk_manager->BeginSequentialAccess();
+  return std::shared_ptr<BufferAccessStrategy>(new BufferAccessStrategy(SCAN_RING_SIZE),
+                                               [disk_manager](BufferAccessStrategy *strategy) {
+                                                 disk_manager->EndSequentialAccess();
+                                                 delete strategy;
+                                               });
+}
+
+std::unique_ptr<ExtentAllocator> BufferPoolManager::NewExtentAllocator(size_t extent_size) {
+  return std::make_unique<ExtentAllocator>(disk_manager_, extent_size);
+}
+
+void BufferPoolManager::RunPrefetchThread() {
+  std::unique_lock prefetch_lock(prefetch_latch_);
+  while (true) {
+    prefetch_cv_.wait(prefetch_lock, [this] { return !prefetch_running_ || !prefetch_queue_.empty(); });
+    if (!prefetch_running_) {
+      return;
+    }
+    // Take a batch of pages, whose reads are all in flight at once.
+    std::vector<std::pair<page_id_t, std::shared_ptr<BufferAccessStrategy>>> batch;
+    while (!prefetch_queue_.empty() && batch.size() < PREFETCH_BATCH_SIZE) {
+      batch.push_back(std::move(prefetch_queue_.front()));
+      prefetch_queue_.pop_front();
+    }
+    prefetch_lock.unlock();
+
+    struct PendingRead {
+      BufferPoolInstance *instance_;
+      frame_id_t frame_id_;
+      page_id_t old_page_id_;
+      page_id_t page_id_;
+      std::future<bool> done_;
+    };
+    std::vector<PendingRead> reads;
+    for (auto &[page_id, strategy] : batch) {
+      BufferPoolInstance *instance = GetInstance(page_id);
+      std::unique_lock lock(instance->latch_);
+      frame_id_t frame_id;
+      size_t access_type = static_cast<size_t>(AccessType::PREFETCH);
+      if (instance->page_table_.Find(page_id) != nullptr) {
+        BufferPoolCounters::Increment(&instance->counters_.hits_[access_type]);
+      } else if (FindFreeFrame(instance, &frame_id, strategy.get())) {
+        BufferPoolCounters::Increment(&instance->counters_.misses_[access_type]);
+        char *data = instance->GetPage(frame_id).data_;
+        page_id_t old_page_id = StartLoad(instance, &lock, frame_id, page_id);
+        reads.push_back({instance, frame_id, old_page_id, page_id, disk_manager_->ReadPageAsync(page_id, data)});
+      }
+    }
+    for (auto &read : reads) {
+      bool succeeded = read.done_.get();
+      std::unique_lock lock(read.instance_->latch_, std::defer_lock);
+      if (!succeeded) {
+        AbortLoad(read.instance_, &lock, read.frame_id_, read.old_page_id_, read.page_id_);
+        continue;
+      }
+      FinishLoad(read.instance_, &lock, read.frame_id_, read.old_page_id_, read.page_id_, false, false);
+      num_prefetches_++;
+    }
+
+    prefetch_lock.lock();
+  }
+}
+
+void BufferPoolManager::StopPrefetchThread() {
+  {
+    std::scoped_lock lock(prefetch_latch_);
+    if (prefetch_thread_ == nullptr) {
+      return;
+    }
+    prefetch_running_ = false;
+    prefetch_queue_.clear();
+  }
+  prefetch_cv_.notify_all();
+  prefetch_thread_->join();
+  prefetch_thread_.reset();
+}
+
 bool BufferPoolManager::UnpinPageImpl(page_id_t page_id, bool is_dirty) {
-  std::scoped_lock lock(latch_);
+  BufferPoolInstance *instance = GetInstance(page_id);
+  // A pinned page stays in its frame, the lock-free lookup only misses it when racing with a change to the page table.
+  BufferPoolInstance::Frame *frame = instance->page_table_.Find(page_id);
+  if (frame == nullptr || frame->page_.page_id_ != page_id) {
+    std::scoped_lock lock(instance->latch_);
+    frame = instance->page_table_.Find(page_id);
+    if (frame == nullptr || frame->page_.page_id_ != page_id) {
+      return false;
+    }
+  }
+  // The page may point into the read-only mapping of the database file, and could not be written back anyway.
+  if (is_dirty && disk_manager_->IsReadOnly()) {
+    ReleasePin(instance, frame, false);
+    return false;
+  }
+  return ReleasePin(instance, frame, is_dirty);
+}
 
-  if (page_table_.count(page_id) == 0) {
+bool BufferPoolManager::FlushFrame(BufferPoolInstance *instance, std::unique_lock<std::mutex> *lock,
+                                   page_id_t page_id, bool background) {
+  // Aligned like the frames, so the copy can be written with direct I/O as is.
+  alignas(PAGE_SIZE) char data[PAGE_SIZE];
+  if (!StartFlush(instance, lock, page_id, background, data)) {
     return false;
   }
-  frame_id_t frame_id = page_table_[page_id];
-  Page &page = pages_[frame_id];
-  if (page.pin_count_ <= 0) {
+  std::vector<PageWrite> batch{{page_id, data}};
+  lock->unlock();
+  WriteFlushBatch(&batch, background);
+  lock->lock();
+  return true;
+}
+
+bool BufferPoolManager::StartFlush(BufferPoolInstance *instance, std::unique_lock<std::mutex> *lock,
+                                   page_id_t page_id, bool background, char *data) {
+  if (disk_manager_->IsReadOnly()) {
     return false;
   }
-  page.pin_count_--;
-  if (is_dirty) {
-    page.is_dirty_ = true;
+  BufferPoolInstance::Frame *frame = instance->page_table_.Find(page_id);
+  while (frame != nullptr) {
+    if (frame->in_io_) {
+      if (background) {
+        return false;
+      }
+      frame->io_done_.wait(*lock);
+    } else if (instance->flushing_pages_.count(page_id) != 0) {
+      if (background) {
+        return false;
+      }
+      instance->flush_done_.wait(*lock);
+    } else {
+      break;
+    }
+    frame = instance->page_table_.Find(page_id);
+  }
+  if (frame == nullptr) {
+    return false;
   }
-  if (page.pin_count_ == 0) {
-    replacer_->Unpin(frame_id);
+  Page &page = frame->page_;
+  if (background && (page.pin_count_ > 0 || !page.is_dirty_)) {
+    return false;
   }
+
+  // Modifications that are unpinned from now on mark the page dirty again, those unpinned before are in the copy.
+  page.is_dirty_ = false;
+  memcpy(data, page.data_, PAGE_SIZE);
+  instance->flushing_pages_.insert(page_id);
   return true;
 }
 
+void BufferPoolManager::WriteFlushBatch(std::vector<PageWrite> *batch, bool background) {
+  if (batch->empty()) {
+    return;
+  }
+  disk_manager_->WritePages(*batch);
+  if (background) {
+    num_background_writes_ += batch->size();
+  } else {
+    num_foreground_writes_ += batch->size();
+  }
+
+  for (const PageWrite &page : *batch) {
+    BufferPoolInstance *instance = GetInstance(page.page_id_);
+    std::scoped_lock lock(instance->latch_);
+    instance->flushing_pages_.erase(page.page_id_);
+    instance->flush_done_.notify_all();
+  }
+  batch->clear();
+}
+
+void BufferPoolManager::BackgroundFlush(BufferPoolInstance *instance, size_t clean_frames) {
+  std::unique_lock lock(instance->latch_);
+  bool wal = enable_logging && log_manager_ != nullptr;
+
+  // Count the frames that can be reused without a write, and collect the unpinned dirty pages as candidates, keyed by
+  // their LSN when there is a log manager and by their page id otherwise.
+  size_t num_clean = instance->free_list_.size();
+  std::vector<std::pair<lsn_t, page_id_t>> candidates;
+  for (size_t i = 0; i < instance->num_frames_; ++i) {
+    BufferPoolInstance::Frame &frame = *instance->frames_[i];
+    Page &page = frame.page_;
+    if (page.page_id_ == INVALID_PAGE_ID || page.pin_count_ > 0 || frame.in_io_) {
+      continue;
+    }
+    if (!page.is_dirty_) {
+      num_clean++;
+    } else if (!wal || page.GetLSN() <= log_manager_->GetPersistentLSN()) {
+      candidates.emplace_back(log_manager_ != nullptr ? page.GetLSN() : page.GetPageId(), page.GetPageId());
+    }
+  }
+  if (num_clean >= clean_frames) {
+    return;
+  }
+
+  std::sort(candidates.begin(), candidates.end());
+  // The pages are copied and written in batches, the background flush never waits on a page in I/O.
+  FrameArena copies(FLUSH_BATCH_SIZE);
+  std::vector<PageWrite> batch;
+  for (size_t i = 0; i < candidates.size() && num_clean < clean_frames; ++i) {
+    char *data = copies.GetFrameData(batch.size());
+    if (StartFlush(instance, &lock, candidates[i].second, true, data)) {
+      batch.push_back({candidates[i].second, data});
+      num_clean++;
+    }
+    if (batch.size() == FLUSH_BATCH_SIZE) {
+      lock.unlock();
+      WriteFlushBatch(&batch, true);
+      lock.lock();
+    }
+  }
+  lock.unlock();
+  WriteFlushBatch(&batch, true);
+}
+
 bool BufferPoolManager::FlushPageImpl(page_id_t page_id) {
-  // Make sure you call DiskManager::WritePage!
-  return false;
+  BufferPoolInstance *instance = GetInstance(page_id);
+  std::unique_lock lock(instance->latch_);
+  return FlushFrame(instance, &lock, page_id, false);
 }
 
-Page *BufferPoolManager::NewPageImpl(page_id_t *page_id) {
-  std::scoped_lock lock(latch_);
+Page *BufferPoolManager::NewPageImpl(page_id_t *page_id, BufferAccessStrategy *strategy,
+                                     ExtentAllocator *extent_allocator) {
+  if (disk_manager_->IsReadOnly()) {
+    return nullptr;
+  }
+  auto allocate_page = [this, extent_allocator]() {
+    return extent_allocator != nullptr ? extent_allocator->AllocatePage() : disk_manager_->AllocatePage();
+  };
+  // With several instances the page id decides which instance the page belongs to, so it has to be allocated before
+  // looking for a frame. A single instance looks for a frame first, so that a full pool does not use up page ids.
+  bool partitioned = instances_.size() > 1;
+  page_id_t new_page_id = partitioned ? allocate_page() : INVALID_PAGE_ID;
+  BufferPoolInstance *instance = partitioned ? GetInstance(new_page_id) : instances_[0].get();
+  std::unique_lock lock(instance->latch_);
 
   frame_id_t frame_id;
-  if (!free_list_.empty()) {
-    frame_id = free_list_.front();
-    free_list_.pop_front();
-  } else {
-    if (!replacer_->Victim(&frame_id)) {
-      return nullptr;
+  if (!FindFreeFrame(instance, &frame_id, strategy)) {
+    if (partitioned) {
+      disk_manager_->DeallocatePage(new_page_id);
     }
-    if (pages_[frame_id].is_dirty_) {
-      disk_manager_->WritePage(pages_[frame_id].page_id_, pages_[frame_id].data_);
-    }
-    page_table_.erase(pages_[frame_id].page_id_);
+    BufferPoolCounters::Increment(&instance->counters_.all_pinned_failures_);
+    return nullptr;
+  }
+  if (!partitioned) {
+    new_page_id = allocate_page();
   }
+  BufferPoolCounters::Increment(&instance->counters_.new_pages_);
 
-  *page_id = disk_manager_->AllocatePage();
-  Page &page = pages_[frame_id];
-  page.page_id_ = *page_id;
-  page.pin_count_ = 1;
-  page.is_dirty_ = false;
-  std::memset(page.data_, 0, BUSTUB_DATE_MIN);
-  page_table_[*page_id] = frame_id;
-  replacer_->Pin(frame_id);
-  return &page;
+  *page_id = new_page_id;
+  return LoadFrame(instance, &lock, frame_id, new_page_id, false, true);
 }
 
 bool BufferPoolManager::DeletePageImpl(page_id_t page_id) {
-  // 0.   Make sure you call DiskManager::DeallocatePage!
-  // 1.   Search the page table for the requested page (P).
-  // 1.   If P does not exist, return true.
-  // 2.   If P exists, but has a non-zero pin-count, return false. Someone is using the page.
-  // 3.   Otherwise, P can be deleted. Remove P from the page table, reset its metadata and return it to the free list.
-  return false;
+  if (disk_manager_->IsReadOnly()) {
+    return false;
+  }
+  BufferPoolInstance *instance = GetInstance(page_id);
+  std::unique_lock lock(instance->latch_);
+
+  // A load or write-back of the page, or a flush of a copy of it, must complete before the page goes away.
+  BufferPoolInstance::Frame *frame = instance->page_table_.Find(page_id);
+  while (frame != nullptr && (frame->in_io_ || instance->flushing_pages_.count(page_id) != 0)) {
+    if (frame->in_io_) {
+      frame->io_done_.wait(lock);
+    } else {
+      instance->flush_done_.wait(lock);
+    }
+    frame = instance->page_table_.Find(page_id);
+  }
+  if (frame != nullptr) {
+    // Claiming the frame fails if someone is using the page, and keeps hits off it otherwise.
+    if (!ClaimFrame(frame)) {
+      return false;
+    }
+    Page &page = frame->page_;
+    if (instance->IsActive(frame->frame_id_)) {
+      instance->replacer_->Remove(frame->frame_id_);
+      // The page is gone, not evicted, so it is not remembered either.
+      instance->replacer_->ReplacePage(frame->frame_id_, INVALID_PAGE_ID, INVALID_PAGE_ID);
+      instance->free_list_.emplace_back(frame->frame_id_);
+    }
+    instance->page_table_.Erase(page_id);
+    page.page_id_ = INVALID_PAGE_ID;
+    page.is_dirty_ = false;
+    frame->out_of_replacer_ = false;
+    page.pin_count_ = 0;
+  }
+  disk_manager_->DeallocatePage(page_id);
+  return true;
 }
 
 void BufferPoolManager::FlushAllPagesImpl() {
-  // You can do it!
+  std::vector<page_id_t> page_ids;
+  for (auto &instance : instances_) {
+    std::scoped_lock lock(instance->latch_);
+    instance->page_table_.ForEach(
+        [&page_ids](page_id_t page_id, BufferPoolInstance::Frame * /*frame*/) { page_ids.push_back(page_id); });
+  }
+  // In page id order across the instances, so that consecutive pages are written together.
+  std::sort(page_ids.begin(), page_ids.end());
+  FrameArena copies(FLUSH_BATCH_SIZE);
+  std::vector<PageWrite> batch;
+  for (page_id_t page_id : page_ids) {
+    BufferPoolInstance *instance = GetInstance(page_id);
+    std::unique_lock lock(instance->latch_);
+    BufferPoolInstance::Frame *frame = instance->page_table_.Find(page_id);
+    // A load waiting for a page of the batch would never complete, write the batch before waiting for any I/O.
+    if (frame != nullptr && (frame->in_io_ || instance->flushing_pages_.count(page_id) != 0)) {
+      lock.unlock();
+      WriteFlushBatch(&batch, false);
+      lock.lock();
+    }
+    char *data = copies.GetFrameData(batch.size());
+    if (StartFlush(instance, &lock, page_id, false, data)) {
+      batch.push_back({page_id, data});
+    }
+    lock.unlock();
+    if (batch.size() == FLUSH_BATCH_SIZE) {
+      WriteFlushBatch(&batch, false);
+    }
+  }
+  WriteFlushBatch(&batch, false);
+  // One durability barrier for all the writes.
+  disk_manager_->Sync();
 }
 
 }  // namespace bustub
@@ -0,0 +1,55 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_set.cpp
+//
+// Identification: src/buffer/buffer_pool_set.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/buffer_pool_set.h"
+
+namespace bustub {
+
+BufferPoolManager *BufferPoolSet::AddPool(const std::string &name, size_t pool_size, size_t num_instances,
+                                          BufferPoolManager::ReplacerType replacer_type) {
+  BUSTUB_ASSERT(names_.count(name) == 0, "Buffer pool names should be unique!");
+  names_[name] = pools_.size();
+  pools_.emplace_back(name, std::make_unique<BufferPoolManager>(pool_size, num_instances, disk_manager_, log_manager_,
+                                                                replacer_type));
+  return pools_.back().second.get();
+}
+
+BufferPoolManager *BufferPoolSet::GetPool(const std::string &name) {
+  auto it = names_.find(name);
+  return it == names_.end() ? nullptr : pools_[it->second].second.get();
+}
+
+BufferPoolManager *BufferPoolSet::GetPool(PageClass page_class) {
+  BUSTUB_ASSERT(!pools_.empty(), "A buffer pool set needs a pool before pages can be routed.");
+  return pools_[routes_[static_cast<size_t>(page_class)]].second.get();
+}
+
+void BufferPoolSet::Route(PageClass page_class, const std::string &name) {
+  BUSTUB_ASSERT(names_.count(name) != 0, "A page class can only be routed to a pool of the set.");
+  routes_[static_cast<size_t>(page_class)] = names_[name];
+}
+
+void BufferPoolSet::FlushAllPages() {
+  for (auto &[name, pool] : pools_) {
+    pool->FlushAllPages();
+  }
+}
+
+std::vector<std::pair<std::string, BufferPoolStats>> BufferPoolSet::GetStats() {
+  std::vector<std::pair<std::string, BufferPoolStats>> stats;
+  for (auto &[name, pool] : pools_) {
+    stats.emplace_back(name, pool->GetStats());
+  }
+  return stats;
+}
+
+}  // namespace bustub
@@ -0,0 +1,86 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_stats.cpp
+//
+// Identification: src/buffer/buffer_pool_stats.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/buffer_pool_stats.h"
+
+#include <numeric>
+#include <sstream>
+
+namespace bustub {
+
+namespace {
+
+const char *const ACCESS_TYPE_NAMES[NUM_ACCESS_TYPES] = {"shared", "strategy", "prefetch"};
+
+}  // namespace
+
+uint64_t BufferPoolStats::GetHits() const { return std::accumulate(hits_.begin(), hits_.end(), uint64_t{0}); }
+
+uint64_t BufferPoolStats::GetMisses() const { return std::accumulate(misses_.begin(), misses_.end(), uint64_t{0}); }
+
+double BufferPoolStats::GetHitRatio() const {
+  uint64_t accesses = GetHits() + GetMisses();
+  return accesses == 0 ? 0 : static_cast<double>(GetHits()) / static_cast<double>(accesses);
+}
+
+BufferPoolStats &BufferPoolStats::operator+=(const BufferPoolStats &other) {
+  for (size_t i = 0; i < NUM_ACCESS_TYPES; ++i) {
+    hits_[i] += other.hits_[i];
+    misses_[i] += other.misses_[i];
+  }
+  new_pages_ += other.new_pages_;
+  evictions_ += other.evictions_;
+  dirty_write_backs_ += other.dirty_write_backs_;
+  all_pinned_failures_ += other.all_pinned_failures_;
+  pin_waits_ += other.pin_waits_;
+  return *this;
+}
+
+std::string BufferPoolStats::ToString() const {
+  std::ostringstream os;
+  os << "hits=" << GetHits() << " misses=" << GetMisses() << " hit_ratio=" << GetHitRatio();
+  for (size_t i = 0; i < NUM_ACCESS_TYPES; ++i) {
+    os << " " << ACCESS_TYPE_NAMES[i] << "_hits=" << hits_[i] << " " << ACCESS_TYPE_NAMES[i]
+       << "_misses=" << misses_[i];
+  }
+  os << " new_pages=" << new_pages_ << " evictions=" << evictions_ << " dirty_write_backs=" << dirty_write_backs_
+     << " all_pinned_failures=" << all_pinned_failures_ << " pin_waits=" << pin_waits_;
+  return os.str();
+}
+
+BufferPoolStats BufferPoolCounters::Snapshot() const {
+  BufferPoolStats stats;
+  for (size_t i = 0; i < NUM_ACCESS_TYPES; ++i) {
+    stats.hits_[i] = hits_[i].load(std::memory_order_relaxed);
+    stats.misses_[i] = misses_[i].load(std::memory_order_relaxed);
+  }
+  stats.new_pages_ = new_pages_.load(std::memory_order_relaxed);
+  stats.evictions_ = evictions_.load(std::memory_order_relaxed);
+  stats.dirty_write_backs_ = dirty_write_backs_.load(std::memory_order_relaxed);
+  stats.all_pinned_failures_ = all_pinned_failures_.load(std::memory_order_relaxed);
+  stats.pin_waits_ = pin_waits_.load(std::memory_order_relaxed);
+  return stats;
+}
+
+void BufferPoolCounters::Reset() {
+  for (size_t i = 0; i < NUM_ACCESS_TYPES; ++i) {
+    hits_[i].store(0, std::memory_order_relaxed);
+    misses_[i].store(0, std::memory_order_relaxed);
+  }
+  new_pages_.store(0, std::memory_order_relaxed);
+  evictions_.store(0, std::memory_order_relaxed);
+  dirty_write_backs_.store(0, std::memory_order_relaxed);
+  all_pinned_failures_.store(0, std::memory_order_relaxed);
+  pin_waits_.store(0, std::memory_order_relaxed);
+}
+
+}  // namespace bustub
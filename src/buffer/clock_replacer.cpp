@@ -14,16 +14,69 @@
 
 namespace bustub {
 
-ClockReplacer::ClockReplacer(size_t num_pages) {}
+ClockReplacer::ClockReplacer(size_t num_pages) : num_pages_(num_pages), frames_(new std::atomic<uint8_t>[num_pages]) {
+  for (size_t i = 0; i < num_pages_; ++i) {
+    frames_[i].store(0, std::memory_order_relaxed);
+  }
+}
 
 ClockReplacer::~ClockReplacer() = default;
 
-bool ClockReplacer::Victim(frame_id_t *frame_id) { return false; }
+bool ClockReplacer::Victim(frame_id_t *frame_id) {
+  std::scoped_lock lock(hand_latch_);
+  // Two full turns of the hand clear every reference bit and come back to an unreferenced frame, unless the frames
+  // change under our feet, in which case we give up rather than spin.
+  for (size_t step = 0; step < 2 * num_pages_ + 1 && size_.load() > 0; ++step) {
+    std::atomic<uint8_t> &frame = frames_[hand_];
+    size_t current = hand_;
+    hand_ = (hand_ + 1) % num_pages_;
 
-void ClockReplacer::Pin(frame_id_t frame_id) {}
+    uint8_t state = frame.load();
+    if ((state & IN_CLOCK) == 0) {
+      continue;
+    }
+    if ((state & REFERENCED) != 0) {
+      frame.fetch_and(static_cast<uint8_t>(~REFERENCED));
+      continue;
+    }
+    // A concurrent Pin or Unpin changes the state and makes the exchange fail, the frame is then skipped.
+    if (frame.compare_exchange_strong(state, 0)) {
+      size_--;
+      *frame_id = static_cast<frame_id_t>(current);
+      return true;
+    }
+  }
+  return false;
+}
 
-void ClockReplacer::Unpin(frame_id_t frame_id) {}
+void ClockReplacer::Pin(frame_id_t frame_id) {
+  BUSTUB_ASSERT(frame_id >= 0 && static_cast<size_t>(frame_id) < num_pages_, "Frame id out of range.");
+  if ((frames_[frame_id].fetch_and(static_cast<uint8_t>(~IN_CLOCK)) & IN_CLOCK) != 0) {
+    size_--;
+  }
+}
 
-size_t ClockReplacer::Size() { return 0; }
+void ClockReplacer::Unpin(frame_id_t frame_id) {
+  BUSTUB_ASSERT(frame_id >= 0 && static_cast<size_t>(frame_id) < num_pages_, "Frame id out of range.");
+  // Count the frame before Victim can see it, so that size_ never drops below the number of frames in the clock.
+  size_++;
+  if ((frames_[frame_id].fetch_or(IN_CLOCK | REFERENCED) & IN_CLOCK) != 0) {
+    size_--;
+  }
+}
+
+bool ClockReplacer::Remove(frame_id_t frame_id) {
+  BUSTUB_ASSERT(frame_id >= 0 && static_cast<size_t>(frame_id) < num_pages_, "Frame id out of range.");
+  uint8_t state = frames_[frame_id].load();
+  while ((state & IN_CLOCK) != 0) {
+    if (frames_[frame_id].compare_exchange_weak(state, 0)) {
+      size_--;
+      return true;
+    }
+  }
+  return false;
+}
+
+size_t ClockReplacer::Size() { return size_.load(); }
 
 }  // namespace bustub
@@ -0,0 +1,61 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_arena.cpp
+//
+// Identification: src/buffer/frame_arena.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/frame_arena.h"
+
+#include <sys/mman.h>
+
+#include "common/exception.h"
+
+namespace bustub {
+
+namespace {
+
+/** Size of a huge page on the platforms we run on. */
+constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+}  // namespace
+
+FrameArena::FrameArena(size_t num_frames) : size_(num_frames * PAGE_SIZE) {
+#ifdef MAP_HUGETLB
+  // Reserved huge pages are only worth asking for if the arena fills at least one.
+  if (size_ >= HUGE_PAGE_SIZE) {
+    size_t huge_size = (size_ + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+    void *data = mmap(nullptr, huge_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (data != MAP_FAILED) {
+      data_ = static_cast<char *>(data);
+      size_ = huge_size;
+      huge_page_backed_ = true;
+      return;
+    }
+  }
+#endif
+
+  void *data = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (data == MAP_FAILED) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "FrameArena: cannot map the frame data.");
+  }
+  data_ = static_cast<char *>(data);
+#ifdef MADV_HUGEPAGE
+  // Only a hint, the arena works the same if transparent huge pages are disabled.
+  madvise(data_, size_, MADV_HUGEPAGE);
+#endif
+}
+
+FrameArena::~FrameArena() { munmap(data_, size_); }
+
+void FrameArena::Release(size_t first_frame, size_t num_frames) {
+  // Only a hint, huge pages can only be released whole and are kept otherwise.
+  madvise(GetFrameData(first_frame), num_frames * PAGE_SIZE, MADV_DONTNEED);
+}
+
+}  // namespace bustub
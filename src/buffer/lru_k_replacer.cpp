@@ -0,0 +1,104 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lru_k_replacer.cpp
+//
+// Identification: src/buffer/lru_k_replacer.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/lru_k_replacer.h"
+
+#include <algorithm>
+
+namespace bustub {
+
+LRUKReplacer::LRUKReplacer(size_t num_pages, size_t k, uint64_t correlated_reference_period)
+    : k_(k),
+      correlated_reference_period_(correlated_reference_period),
+      history_(num_pages * k),
+      num_references_(num_pages),
+      last_access_(num_pages),
+      evictable_(num_pages) {
+  BUSTUB_ASSERT(k_ > 0, "LRU-K needs at least one reference per frame.");
+}
+
+LRUKReplacer::~LRUKReplacer() = default;
+
+bool LRUKReplacer::Victim(frame_id_t *frame_id) {
+  std::scoped_lock lock(latch_);
+  auto &frames = cold_frames_.empty() ? hot_frames_ : cold_frames_;
+  if (frames.empty()) {
+    return false;
+  }
+  *frame_id = frames.begin()->second;
+  frames.erase(frames.begin());
+  evictable_[*frame_id] = false;
+  // The frame will hold another page, whose history starts from scratch.
+  num_references_[*frame_id] = 0;
+  return true;
+}
+
+void LRUKReplacer::Pin(frame_id_t frame_id) {
+  std::scoped_lock lock(latch_);
+  BUSTUB_ASSERT(frame_id >= 0 && static_cast<size_t>(frame_id) < evictable_.size(), "Frame id out of range.");
+  if (evictable_[frame_id]) {
+    Unlink(frame_id);
+  }
+
+  uint64_t now = ++current_timestamp_;
+  size_t &num_references = num_references_[frame_id];
+  if (num_references == 0 || now - last_access_[frame_id] > correlated_reference_period_) {
+    // An uncorrelated access is a new reference.
+    num_references = std::min(num_references + 1, k_);
+    for (size_t i = num_references - 1; i > 0; --i) {
+      History(frame_id, i) = History(frame_id, i - 1);
+    }
+    History(frame_id, 0) = now;
+  }
+  last_access_[frame_id] = now;
+}
+
+void LRUKReplacer::Unpin(frame_id_t frame_id) {
+  std::scoped_lock lock(latch_);
+  BUSTUB_ASSERT(frame_id >= 0 && static_cast<size_t>(frame_id) < evictable_.size(), "Frame id out of range.");
+  if (evictable_[frame_id]) {
+    return;
+  }
+  if (num_references_[frame_id] < k_) {
+    cold_frames_.emplace(last_access_[frame_id], frame_id);
+  } else {
+    hot_frames_.emplace(History(frame_id, k_ - 1), frame_id);
+  }
+  evictable_[frame_id] = true;
+}
+
+bool LRUKReplacer::Remove(frame_id_t frame_id) {
+  std::scoped_lock lock(latch_);
+  BUSTUB_ASSERT(frame_id >= 0 && static_cast<size_t>(frame_id) < evictable_.size(), "Frame id out of range.");
+  if (!evictable_[frame_id]) {
+    return false;
+  }
+  Unlink(frame_id);
+  num_references_[frame_id] = 0;
+  return true;
+}
+
+size_t LRUKReplacer::Size() {
+  std::scoped_lock lock(latch_);
+  return cold_frames_.size() + hot_frames_.size();
+}
+
+void LRUKReplacer::Unlink(frame_id_t frame_id) {
+  if (num_references_[frame_id] < k_) {
+    cold_frames_.erase({last_access_[frame_id], frame_id});
+  } else {
+    hot_frames_.erase({History(frame_id, k_ - 1), frame_id});
+  }
+  evictable_[frame_id] = false;
+}
+
+}  // namespace bustub
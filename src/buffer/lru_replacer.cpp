@@ -1,65 +1,83 @@
-//===----------------------------------------------------------------------===//                                        
-//                                                                                                                      
-//                         BusTub                                                                                      
-//                                                                                                                      
-// lru_replacer.cpp                                                                                                    
-//                                                                                                                      
-// Identification: src/buffer/lru_replacer.cpp                                                                          
-//                                                                                                                      
-// Copyright (c) 2015-2019, Carnegie Mellon University Database Group                                                  
-//                                                                                                                      
-//===----------------------------------------------------------------------===//                                        
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lru_replacer.cpp
+//
+// Identification: src/buffer/lru_replacer.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
 
 #include "buffer/lru_replacer.h"
 
 namespace bustub {
 
-LRUReplacer::LRUReplacer(size_t num_pages) {}
+LRUReplacer::LRUReplacer(size_t num_pages)
+    : head_(static_cast<frame_id_t>(num_pages)), prev_(num_pages + 1), next_(num_pages + 1), in_list_(num_pages) {
+  // An empty list is the sentinel linked to itself.
+  prev_[head_] = head_;
+  next_[head_] = head_;
+}
 
 LRUReplacer::~LRUReplacer() = default;
 
 bool LRUReplacer::Victim(frame_id_t *frame_id) {
-    lru_mutex.lock();
-
-    if (unpinned_frames.empty()) {
-         lru_mutex.unlock();
-         return false;
-    }
-    *frame_id = unpinned_frames.front();
-    unpinned_frames.pop_front();
-
-    lru_mutex.unlock();
-    return true;
+  std::scoped_lock lock(lru_mutex_);
+  if (size_ == 0) {
+    return false;
+  }
+  // The least recently unpinned frame is at the front of the list.
+  *frame_id = next_[head_];
+  Unlink(*frame_id);
+  return true;
 }
 
 void LRUReplacer::Pin(frame_id_t frame_id) {
-    lru_mutex.lock();
-    for (auto it = unpinned_frames.begin(); it !=  unpinned_frames.end(); it++) {
-        if (*it == frame_id) {
-            unpinned_frames.erase(it);
-            break;
-        }
-    }
-    lru_mutex.unlock();
+  std::scoped_lock lock(lru_mutex_);
+  BUSTUB_ASSERT(frame_id >= 0 && frame_id < head_, "Frame id out of range.");
+  if (in_list_[frame_id]) {
+    Unlink(frame_id);
+  }
 }
 
 void LRUReplacer::Unpin(frame_id_t frame_id) {
-    lru_mutex.lock();
-    for (auto it = unpinned_frames.begin(); it != unpinned_frames.end(); ++it) {
-        if (*it == frame_id) {
-            lru_mutex.unlock();
-            return;
-        }
-    }
-    unpinned_frames.push_back(frame_id);
-    lru_mutex.unlock();
+  std::scoped_lock lock(lru_mutex_);
+  BUSTUB_ASSERT(frame_id >= 0 && frame_id < head_, "Frame id out of range.");
+  // Unpinning a frame that is already unpinned does not refresh its position.
+  if (in_list_[frame_id]) {
+    return;
+  }
+  frame_id_t tail = prev_[head_];
+  prev_[frame_id] = tail;
+  next_[frame_id] = head_;
+  next_[tail] = frame_id;
+  prev_[head_] = frame_id;
+  in_list_[frame_id] = true;
+  size_++;
+}
+
+bool LRUReplacer::Remove(frame_id_t frame_id) {
+  std::scoped_lock lock(lru_mutex_);
+  BUSTUB_ASSERT(frame_id >= 0 && frame_id < head_, "Frame id out of range.");
+  if (!in_list_[frame_id]) {
+    return false;
+  }
+  Unlink(frame_id);
+  return true;
 }
 
 size_t LRUReplacer::Size() {
-    lru_mutex.lock();
-    size_t size = unpinned_frames.size();
-    lru_mutex.unlock();
-    return size;
+  std::scoped_lock lock(lru_mutex_);
+  return size_;
+}
+
+void LRUReplacer::Unlink(frame_id_t frame_id) {
+  next_[prev_[frame_id]] = next_[frame_id];
+  prev_[next_[frame_id]] = prev_[frame_id];
+  in_list_[frame_id] = false;
+  size_--;
 }
 
 }  // namespace bustub
@@ -0,0 +1,149 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// crc32c_util.cpp
+//
+// Identification: src/common/util/crc32c_util.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "common/util/crc32c_util.h"
+
+#include <array>
+#include <cstring>
+
+#if defined(__x86_64__)
+#include <nmmintrin.h>
+#endif
+
+namespace bustub {
+
+namespace {
+
+/** The CRC32C polynomial, bit-reversed. */
+constexpr uint32_t CRC32C_POLYNOMIAL = 0x82F63B78;
+
+/** The CRC32C of every byte value, for the software fallback. */
+constexpr std::array<uint32_t, 256> MakeCrc32cTable() {
+  std::array<uint32_t, 256> table{};
+  for (uint32_t i = 0; i < 256; ++i) {
+    uint32_t crc = i;
+    for (int bit = 0; bit < 8; ++bit) {
+      crc = (crc >> 1) ^ ((crc & 1) != 0 ? CRC32C_POLYNOMIAL : 0);
+    }
+    table[i] = crc;
+  }
+  return table;
+}
+
+constexpr std::array<uint32_t, 256> CRC32C_TABLE = MakeCrc32cTable();
+
+/** Bytes of each of the three streams the hardware path checksums at once. */
+constexpr size_t CRC32C_STREAM_LENGTH = 256;
+
+/** @return a times b modulo the polynomial, both bit-reversed */
+uint32_t MultiplyModPolynomial(uint32_t a, uint32_t b) {
+  uint32_t product = 0;
+  for (uint32_t m = uint32_t{1} << 31; m != 0; m >>= 1) {
+    if ((a & m) != 0) {
+      product ^= b;
+    }
+    b = (b & 1) != 0 ? (b >> 1) ^ CRC32C_POLYNOMIAL : b >> 1;
+  }
+  return product;
+}
+
+/**
+ * Tables appending CRC32C_STREAM_LENGTH zero bytes to a CRC register, one byte of the register per table: the register
+ * times x to the power of 8 * CRC32C_STREAM_LENGTH, modulo the polynomial.
+ */
+std::array<std::array<uint32_t, 256>, 4> MakeCrc32cShiftTables() {
+  // x^0 is the top bit, x^1 the next one
+  uint32_t power = uint32_t{1} << 31;
+  uint32_t square = uint32_t{1} << 30;
+  for (size_t n = 8 * CRC32C_STREAM_LENGTH; n != 0; n >>= 1) {
+    if ((n & 1) != 0) {
+      power = MultiplyModPolynomial(power, square);
+    }
+    square = MultiplyModPolynomial(square, square);
+  }
+  std::array<std::array<uint32_t, 256>, 4> tables{};
+  for (uint32_t byte = 0; byte < 4; ++byte) {
+    for (uint32_t value = 0; value < 256; ++value) {
+      tables[byte][value] = MultiplyModPolynomial(power, value << (8 * byte));
+    }
+  }
+  return tables;
+}
+
+/** @return the CRC register after CRC32C_STREAM_LENGTH more zero bytes */
+uint32_t ShiftCrc32c(uint32_t crc) {
+  static const std::array<std::array<uint32_t, 256>, 4> shift_tables = MakeCrc32cShiftTables();
+  return shift_tables[0][crc & 0xFF] ^ shift_tables[1][(crc >> 8) & 0xFF] ^ shift_tables[2][(crc >> 16) & 0xFF] ^
+         shift_tables[3][crc >> 24];
+}
+
+}  // namespace
+
+uint32_t Crc32cUtil::Crc32c(const char *data, size_t length) {
+  static const bool hardware = IsHardwareAccelerated();
+  uint32_t crc = ~uint32_t{0};
+  crc = hardware ? Crc32cHardware(crc, data, length) : Crc32cSoftware(crc, data, length);
+  return ~crc;
+}
+
+bool Crc32cUtil::IsHardwareAccelerated() {
+#if defined(__x86_64__)
+  return __builtin_cpu_supports("sse4.2");
+#else
+  return false;
+#endif
+}
+
+#if defined(__x86_64__)
+__attribute__((target("sse4.2"))) uint32_t Crc32cUtil::Crc32cHardware(uint32_t crc, const char *data, size_t length) {
+  // The crc32 instruction takes three cycles but can start every cycle: checksum three consecutive streams at once,
+  // then combine them, as the CRC of a concatenation is the CRC of the first part shifted past the second part.
+  uint64_t crc64 = crc;
+  for (; length >= 3 * CRC32C_STREAM_LENGTH; data += 3 * CRC32C_STREAM_LENGTH, length -= 3 * CRC32C_STREAM_LENGTH) {
+    uint64_t crc1 = 0;
+    uint64_t crc2 = 0;
+    for (size_t offset = 0; offset < CRC32C_STREAM_LENGTH; offset += sizeof(uint64_t)) {
+      uint64_t words[3];
+      memcpy(&words[0], data + offset, sizeof(uint64_t));
+      memcpy(&words[1], data + CRC32C_STREAM_LENGTH + offset, sizeof(uint64_t));
+      memcpy(&words[2], data + 2 * CRC32C_STREAM_LENGTH + offset, sizeof(uint64_t));
+      crc64 = _mm_crc32_u64(crc64, words[0]);
+      crc1 = _mm_crc32_u64(crc1, words[1]);
+      crc2 = _mm_crc32_u64(crc2, words[2]);
+    }
+    crc64 = ShiftCrc32c(ShiftCrc32c(static_cast<uint32_t>(crc64)) ^ static_cast<uint32_t>(crc1)) ^ crc2;
+  }
+  for (; length >= sizeof(uint64_t); data += sizeof(uint64_t), length -= sizeof(uint64_t)) {
+    uint64_t word;
+    memcpy(&word, data, sizeof(word));
+    crc64 = _mm_crc32_u64(crc64, word);
+  }
+  crc = static_cast<uint32_t>(crc64);
+  for (; length > 0; ++data, --length) {
+    crc = _mm_crc32_u8(crc, static_cast<uint8_t>(*data));
+  }
+  return crc;
+}
+#else
+uint32_t Crc32cUtil::Crc32cHardware(uint32_t crc, const char *data, size_t length) {
+  return Crc32cSoftware(crc, data, length);
+}
+#endif
+
+uint32_t Crc32cUtil::Crc32cSoftware(uint32_t crc, const char *data, size_t length) {
+  for (size_t i = 0; i < length; ++i) {
+    crc = (crc >> 8) ^ CRC32C_TABLE[(crc ^ static_cast<uint8_t>(data[i])) & 0xFF];
+  }
+  return crc;
+}
+
+}  // namespace bustub
@@ -0,0 +1,128 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// arc_replacer.h
+//
+// Identification: src/include/buffer/arc_replacer.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <list>
+#include <mutex>  // NOLINT
+#include <set>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "buffer/replacer.h"
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * ARCReplacer implements the Adaptive Replacement Cache policy.
+ *
+ * Frames are split between a recency list T1, of pages referenced once since they were loaded, and a frequency list
+ * T2, of pages referenced again. Pinning an unpinned frame is a reference, pinning a frame that is already pinned is
+ * not. The victim is the least recently referenced unpinned frame of T1 while T1 holds more than a target number of
+ * frames, and of T2 otherwise.
+ *
+ * The replacer learns from ReplacePage which page a frame held when it was evicted, and remembers the page in a ghost
+ * list B1 or B2, depending on the list its frame was in. Loading a page that is still in B1 means T1 was too small,
+ * and grows the target; loading a page that is still in B2 shrinks it. Pages loaded from a ghost list go straight to
+ * T2. The replacer thereby tunes itself between recency and frequency as the workload shifts.
+ */
+class ARCReplacer : public Replacer {
+ public:
+  /**
+   * Create a new ARCReplacer.
+   * @param num_pages the maximum number of pages the ARCReplacer will be required to store, frame ids must be in
+   * [0, num_pages)
+   */
+  explicit ARCReplacer(size_t num_pages);
+
+  /**
+   * Destroys the ARCReplacer.
+   */
+  ~ARCReplacer() override;
+
+  bool Victim(frame_id_t *frame_id) override;
+
+  void Pin(frame_id_t frame_id) override;
+
+  void Unpin(frame_id_t frame_id) override;
+
+  bool Remove(frame_id_t frame_id) override;
+
+  size_t Size() override;
+
+  void ReplacePage(frame_id_t frame_id, page_id_t old_page_id, page_id_t page_id) override;
+
+  /** @return the number of frames T1 should hold, which victims are taken from T1 above */
+  size_t GetRecencyTarget();
+
+ private:
+  /** The list a frame is in. */
+  enum class FrameList { NONE, T1, T2 };
+
+  /** A ghost list, of pages evicted recently, most recently evicted first. */
+  class GhostList {
+   public:
+    /** Adds a page at the front of the list. */
+    void Push(page_id_t page_id);
+    /** Removes a page, @return true if it was in the list */
+    bool Erase(page_id_t page_id);
+    /** Forgets the page evicted the longest ago. */
+    void Pop();
+    /** @return the number of pages in the list */
+    size_t Size() const { return pages_.size(); }
+
+   private:
+    std::list<page_id_t> pages_;
+    std::unordered_map<page_id_t, std::list<page_id_t>::iterator> positions_;
+  };
+
+  /** Puts a frame that is in no list into a list, as a new reference. The caller must hold latch_. */
+  void Link(frame_id_t frame_id, FrameList list);
+
+  /** Removes an unpinned frame from the unpinned frames of its list. The caller must hold latch_. */
+  void Unlink(frame_id_t frame_id);
+
+  /** Drops the oldest ghosts until the lists hold at most twice the capacity. The caller must hold latch_. */
+  void TrimGhosts();
+
+  /** @return the unpinned frames of a list */
+  std::set<std::pair<uint64_t, frame_id_t>> &Evictable(FrameList list) { return list == FrameList::T1 ? t1_ : t2_; }
+
+  /** The maximum number of frames. */
+  size_t capacity_;
+  /** Target number of frames in T1, between 0 and capacity_. */
+  size_t target_{0};
+  /** The logical clock, incremented on every reference. */
+  uint64_t current_timestamp_{0};
+  /** The list every frame is in, pinned or not. */
+  std::vector<FrameList> lists_;
+  /** Time of the last reference of every frame. */
+  std::vector<uint64_t> last_reference_;
+  /** evictable_[f] is true iff frame f is unpinned and can be victimized. */
+  std::vector<bool> evictable_;
+  /** Number of frames in T1 and in T2, pinned or not. */
+  size_t t1_size_{0};
+  size_t t2_size_{0};
+  /** Unpinned frames of T1 and of T2, ordered by last reference. */
+  std::set<std::pair<uint64_t, frame_id_t>> t1_;
+  std::set<std::pair<uint64_t, frame_id_t>> t2_;
+  /** Pages evicted from T1 and from T2. */
+  GhostList b1_;
+  GhostList b2_;
+  /** Protects all of the above. */
+  std::mutex latch_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,68 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_access_strategy.h
+//
+// Identification: src/include/buffer/buffer_access_strategy.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <mutex>  // NOLINT
+#include <vector>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * BufferAccessStrategy gives a sequential scan or a bulk load a small private ring of frames. When a page fetched or
+ * created through the strategy misses, the buffer pool recycles the frame in the next slot of the ring if nobody else
+ * is using it, instead of evicting a frame of the shared pool. A large scan therefore only ever occupies ring_size
+ * frames and leaves the rest of the pool alone.
+ *
+ * Every scan or load should use its own strategy. The ring is latched because the buffer pool's prefetch thread may
+ * load pages into it while the scan runs.
+ */
+class BufferAccessStrategy {
+  friend class BufferPoolManager;
+
+ public:
+  /**
+   * Creates a new BufferAccessStrategy.
+   * @param ring_size the number of frames in the ring
+   */
+  explicit BufferAccessStrategy(size_t ring_size) : ring_(ring_size, RingFrame{0, INVALID_FRAME_ID}) {
+    BUSTUB_ASSERT(ring_size > 0, "A ring needs at least one frame.");
+  }
+
+  DISALLOW_COPY_AND_MOVE(BufferAccessStrategy);
+
+  ~BufferAccessStrategy() = default;
+
+  /** @return the number of frames in the ring */
+  size_t GetRingSize() const { return ring_.size(); }
+
+ private:
+  static constexpr frame_id_t INVALID_FRAME_ID = -1;
+
+  /** A frame of the ring, identified by the buffer pool instance it belongs to and its id within the instance. */
+  struct RingFrame {
+    size_t instance_;
+    frame_id_t frame_id_;
+  };
+
+  /** Frames used by the strategy so far, INVALID_FRAME_ID for the slots not used yet. */
+  std::vector<RingFrame> ring_;
+  /** The slot to recycle next. */
+  size_t current_{0};
+  /** This latch protects the ring, it is taken after the latch of a buffer pool instance. */
+  std::mutex latch_;
+};
+
+}  // namespace bustub
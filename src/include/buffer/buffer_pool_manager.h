@@ -12,39 +12,82 @@
 
 #pragma once
 
+#include <atomic>
+#include <condition_variable>  // NOLINT
+#include <cstddef>
+#include <deque>
 #include <list>
+#include <memory>
 #include <mutex>  // NOLINT
+#include <string>
+#include <thread>  // NOLINT
 #include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
 
+#include "buffer/arc_replacer.h"
+#include "buffer/buffer_access_strategy.h"
+#include "buffer/buffer_pool_stats.h"
+#include "buffer/clock_replacer.h"
+#include "buffer/frame_arena.h"
+#include "buffer/lru_k_replacer.h"
 #include "buffer/lru_replacer.h"
+#include "buffer/page_table.h"
 #include "recovery/log_manager.h"
 #include "storage/disk/disk_manager.h"
+#include "storage/disk/extent_allocator.h"
 #include "storage/page/page.h"
+#include "storage/page/page_guard.h"
 
 namespace bustub {
 
 /**
  * BufferPoolManager reads disk pages to and from its internal buffer pool.
+ *
+ * Over a read-only database file mapped by the disk manager (PageIOMode::MMAP_READ_ONLY), frames point straight into
+ * the mapping instead of holding a copy of their page, pages cannot be created and are never written back.
  */
 class BufferPoolManager {
  public:
   enum class CallbackType { BEFORE, AFTER };
   using bufferpool_callback_fn = void (*)(enum CallbackType, const page_id_t page_id);
+  /** The replacement policy used to pick victim frames. */
+  enum class ReplacerType { LRU, CLOCK, LRU_K, ARC };
 
   /**
    * Creates a new BufferPoolManager.
    * @param pool_size the size of the buffer pool
    * @param disk_manager the disk manager
    * @param log_manager the log manager (for testing only: nullptr = disable logging)
+   * @param replacer_type the replacement policy of the buffer pool
    */
-  BufferPoolManager(size_t pool_size, DiskManager *disk_manager, LogManager *log_manager = nullptr);
+  BufferPoolManager(size_t pool_size, DiskManager *disk_manager, LogManager *log_manager = nullptr,
+                    ReplacerType replacer_type = ReplacerType::LRU);
+
+  /**
+   * Creates a new BufferPoolManager whose frames are partitioned into independent instances. Every instance has its
+   * own page table, free list, replacer and latch, and a page always lives in the instance picked by its page id, so
+   * operations on pages of different instances never contend on the same latch.
+   * @param pool_size the size of the buffer pool, split as evenly as possible between the instances
+   * @param num_instances the number of instances to partition the buffer pool into
+   * @param disk_manager the disk manager
+   * @param log_manager the log manager (for testing only: nullptr = disable logging)
+   * @param replacer_type the replacement policy of every instance
+   */
+  BufferPoolManager(size_t pool_size, size_t num_instances, DiskManager *disk_manager,
+                    LogManager *log_manager = nullptr, ReplacerType replacer_type = ReplacerType::LRU);
 
   /**
    * Destroys an existing BufferPoolManager.
    */
   ~BufferPoolManager();
 
-  /** Grading function. Do not modify! */
+  /**
+   * Grading function. Do not modify!
+   * The data of a page of a read-only database file may lie in a read-only mapping of the file, it must not be written
+   * through the page returned.
+   */
   Page *FetchPage(page_id_t page_id, bufferpool_callback_fn callback = nullptr) {
     GradingCallback(callback, CallbackType::BEFORE, page_id);
     auto *result = FetchPageImpl(page_id);
@@ -52,6 +95,90 @@ class BufferPoolManager {
     return result;
   }
 
+  /**
+   * Fetch the requested page, recycling a frame of the strategy's ring instead of evicting one from the shared pool
+   * if the page has to be read from disk.
+   * @param page_id id of page to be fetched
+   * @param strategy the ring of frames to recycle, nullptr for the shared pool
+   * @return the requested page
+   */
+  Page *FetchPage(page_id_t page_id, BufferAccessStrategy *strategy) { return FetchPageImpl(page_id, strategy); }
+
+  /** Fetch the requested page without a callback, for calls passing a null pointer that could be either overload. */
+  Page *FetchPage(page_id_t page_id, std::nullptr_t /*callback*/) { return FetchPageImpl(page_id); }
+
+  /**
+   * Fetch the requested page and guard its pin.
+   * @param page_id id of page to be fetched
+   * @param strategy the ring of frames to recycle on a miss, nullptr for the shared pool
+   * @return a guard of the requested page, empty if it could not be fetched
+   */
+  BasicPageGuard FetchPageBasic(page_id_t page_id, BufferAccessStrategy *strategy = nullptr);
+
+  /**
+   * Fetch the requested page and latch it for reading.
+   * @param page_id id of page to be fetched
+   * @param strategy the ring of frames to recycle on a miss, nullptr for the shared pool
+   * @return a guard of the requested page, empty if it could not be fetched
+   */
+  ReadPageGuard FetchPageRead(page_id_t page_id, BufferAccessStrategy *strategy = nullptr);
+
+  /**
+   * Fetch the requested page and latch it for writing.
+   * @param page_id id of page to be fetched
+   * @param strategy the ring of frames to recycle on a miss, nullptr for the shared pool
+   * @return a guard of the requested page, empty if it could not be fetched or the database file is read-only
+   */
+  WritePageGuard FetchPageWrite(page_id_t page_id, BufferAccessStrategy *strategy = nullptr);
+
+  /**
+   * Creates a new page and guards its pin.
+   * @param[out] page_id id of created page
+   * @param strategy the ring of frames to recycle, nullptr for the shared pool
+   * @param extent_allocator the extents of the table or index to allocate the page in, nullptr to allocate it alone
+   * @return a guard of the new page, empty if no new page could be created
+   */
+  BasicPageGuard NewPageGuarded(page_id_t *page_id, BufferAccessStrategy *strategy = nullptr,
+                                ExtentAllocator *extent_allocator = nullptr);
+
+  /**
+   * Pin the requested page if it is in the buffer pool and readable, without any I/O or waiting.
+   * @param page_id id of page to be fetched
+   * @return the requested page, nullptr if it is not in the buffer pool or still being loaded
+   */
+  Page *TryFetchPage(page_id_t page_id);
+
+  /**
+   * Start loading a page into the buffer pool without pinning it and without blocking the caller. The page is read by
+   * the prefetch thread, and a later FetchPage finds it in the pool or waits for the read in progress. Prefetches are
+   * hints: they are dropped when the queue is full, and skipped when the page is already in the pool or every frame
+   * is pinned. Over a read-only mapped database file, the page is not loaded, the kernel is only told to read it.
+   * @param page_id id of page to be prefetched
+   * @param strategy the ring of frames to load the page into, nullptr for the shared pool
+   */
+  void PrefetchPage(page_id_t page_id, std::shared_ptr<BufferAccessStrategy> strategy = nullptr);
+
+  /**
+   * Start loading several pages into the buffer pool, in order, as PrefetchPage does.
+   * @param page_ids ids of the pages to be prefetched
+   * @param strategy the ring of frames to load the pages into, nullptr for the shared pool
+   */
+  void PrefetchPages(const std::vector<page_id_t> &page_ids, std::shared_ptr<BufferAccessStrategy> strategy = nullptr);
+
+  /**
+   * Creates the strategy of a sequential scan, with a ring of SCAN_RING_SIZE frames. As long as the strategy lives, a
+   * read-only mapped database file is read sequentially.
+   * @return the strategy
+   */
+  std::shared_ptr<BufferAccessStrategy> NewScanStrategy();
+
+  /**
+   * Creates the allocator a table or an index creates its pages with, in extents of consecutive pages.
+   * @param extent_size the number of pages of an extent
+   * @return the allocator
+   */
+  std::unique_ptr<ExtentAllocator> NewExtentAllocator(size_t extent_size = EXTENT_SIZE);
+
   /** Grading function. Do not modify! */
   bool UnpinPage(page_id_t page_id, bool is_dirty, bufferpool_callback_fn callback = nullptr) {
     GradingCallback(callback, CallbackType::BEFORE, page_id);
@@ -76,6 +203,20 @@ class BufferPoolManager {
     return result;
   }
 
+  /**
+   * Creates a new page in a frame of the strategy's ring, if one can be recycled, or in a frame of the shared pool.
+   * @param[out] page_id id of created page
+   * @param strategy the ring of frames to recycle, nullptr for the shared pool
+   * @param extent_allocator the extents of the table or index to allocate the page in, nullptr to allocate it alone
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  Page *NewPage(page_id_t *page_id, BufferAccessStrategy *strategy, ExtentAllocator *extent_allocator = nullptr) {
+    return NewPageImpl(page_id, strategy, extent_allocator);
+  }
+
+  /** Creates a new page without a callback, for calls passing a null pointer that could be either overload. */
+  Page *NewPage(page_id_t *page_id, std::nullptr_t /*callback*/) { return NewPageImpl(page_id); }
+
   /** Grading function. Do not modify! */
   bool DeletePage(page_id_t page_id, bufferpool_callback_fn callback = nullptr) {
     GradingCallback(callback, CallbackType::BEFORE, page_id);
@@ -91,13 +232,385 @@ class BufferPoolManager {
     GradingCallback(callback, CallbackType::AFTER, INVALID_PAGE_ID);
   }
 
-  /** @return pointer to all the pages in the buffer pool */
-  Page *GetPages() { return pages_; }
+  /** @return pointers to all the pages in the buffer pool, valid until the pool is shrunk */
+  std::vector<Page *> GetPages();
 
   /** @return size of the buffer pool */
   size_t GetPoolSize() { return pool_size_; }
 
+  /** @return true if the database file is read-only, whose pages can be read but not created, written or deleted */
+  bool IsReadOnly() { return disk_manager_->IsReadOnly(); }
+
+  /**
+   * Grows or shrinks the buffer pool while it stays online. New frames go to the free lists right away. Frames that
+   * are removed stop being handed out at once, and their pages are written back if dirty and evicted as soon as they
+   * are unpinned, so shrinking blocks until every page of the removed frames has been unpinned.
+   * @param pool_size the new size of the buffer pool, at least one frame per instance
+   */
+  void Resize(size_t pool_size);
+
+  /** @return number of instances the buffer pool is partitioned into */
+  size_t GetNumInstances() { return instances_.size(); }
+
+  /**
+   * Starts the background flush thread. Every bgwriter_interval, it writes back unpinned dirty pages of every instance
+   * until the instance has clean_frames frames that can be reused without a write. Pages are written in LSN order when
+   * a log manager is present, and only once their log records are persistent if logging is enabled.
+   * @param clean_frames the number of clean reusable frames to keep in every instance
+   */
+  void RunBackgroundFlushThread(size_t clean_frames = BGWRITER_CLEAN_FRAMES);
+
+  /** Stops the background flush thread, if it is running. */
+  void StopBackgroundFlushThread();
+
+  /** @return number of pages written back by evictions and explicit flushes */
+  uint64_t GetNumForegroundWrites() const { return num_foreground_writes_; }
+
+  /** @return number of pages written back by the background flush thread */
+  uint64_t GetNumBackgroundWrites() const { return num_background_writes_; }
+
+  /** @return number of pages read by the prefetch thread */
+  uint64_t GetNumPrefetches() const { return num_prefetches_; }
+
+  /** @return a snapshot of the counters of the whole buffer pool, summed over its instances */
+  BufferPoolStats GetStats();
+
+  /**
+   * @param instance position of the instance, less than GetNumInstances()
+   * @return a snapshot of the counters of one instance
+   */
+  BufferPoolStats GetInstanceStats(size_t instance) { return instances_[instance]->counters_.Snapshot(); }
+
+  /** Sets every counter of the buffer pool back to zero. */
+  void ResetStats();
+
+  /**
+   * Lists the pinned pages, to track down pins that are never released. Every instance is latched in turn, so the list
+   * is not a consistent cut of the pool while it is in use.
+   * @return the id and pin count of every pinned page, in page id order
+   */
+  std::vector<std::pair<page_id_t, int>> GetPinnedPages();
+
+  /** @return the pinned pages listed by GetPinnedPages, one "page <id>: <pin count> pins" line each */
+  std::string DumpPinnedPages();
+
  protected:
+  /**
+   * BufferPoolInstance is one partition of the buffer pool. Frame ids stored in its free list and its replacer are
+   * indices into its own frames_.
+   *
+   * Hits do not take the instance latch. They look the page up in the lock-free page table and pin its frame with a
+   * compare-and-swap on the pin count, which fails while the frame is claimed. A frame is claimed, by setting its pin
+   * count to CLAIMED, before its page is replaced or evicted, and only a frame with no pin can be claimed. Hits leave
+   * the replacer alone, so the replacer may return pinned frames, which cannot be claimed and are skipped. The last
+   * unpin of a skipped or newly loaded frame takes the latch to hand it back to the replacer. Any other last unpin
+   * records the access in the replacer if the latch is free, and otherwise leaves it pending, so that hits never wait
+   * for the latch. Pending accesses are recorded before the next victim is picked.
+   */
+  struct BufferPoolInstance {
+    BufferPoolInstance(size_t index, size_t num_frames, ReplacerType replacer_type);
+
+    /** The metadata of a frame of the buffer pool, on its own cache lines. Its page data lives in a FrameArena. */
+    struct alignas(CACHE_LINE_SIZE) Frame {
+      /** Id of the frame in its instance. */
+      frame_id_t frame_id_;
+      /** The page held by the frame. */
+      Page page_{nullptr};
+      /** The data of the frame in its FrameArena, where page_ points unless its page is in a mapped database file. */
+      char *arena_data_;
+      /** Set while the frame is written back or loaded without holding the latch. */
+      bool in_io_{false};
+      /** Set while the frame is pinned and out of the replacer, so that its last unpin hands it back. */
+      std::atomic<bool> out_of_replacer_{false};
+      /** Set while an access of the frame waits in the pending accesses of its instance. */
+      std::atomic<bool> access_pending_{false};
+      /** Notified when the I/O on the frame completes. */
+      std::condition_variable io_done_;
+    };
+
+    /**
+     * FrameChunk holds the frames added to the instance at once, their metadata in one dense array and their data in
+     * one arena. Chunks are never moved, so pages stay where they are when the pool is resized, and never freed
+     * before the pool, since a lock-free lookup may still reach a frame that was removed by a resize.
+     */
+    struct FrameChunk {
+      /**
+       * Creates a new FrameChunk.
+       * @param first_frame_id the id of the first frame of the chunk in the instance
+       * @param num_frames the number of frames of the chunk
+       */
+      FrameChunk(size_t first_frame_id, size_t num_frames);
+
+      /** Id of the first frame of the chunk. */
+      size_t first_frame_id_;
+      /** Number of frames of the chunk. */
+      size_t num_frames_;
+      /** Data of the frames. */
+      FrameArena arena_;
+      /** Metadata of the frames. */
+      std::unique_ptr<Frame[]> frames_;
+    };
+
+    /** @return the page held by the frame */
+    Page &GetPage(frame_id_t frame_id) { return frames_[frame_id]->page_; }
+
+    /**
+     * Adds frames to frames_, reusing the frames removed by a shrink before allocating a new chunk.
+     * @param num_frames the new size of frames_
+     */
+    void AddFrames(size_t num_frames);
+
+    /**
+     * Removes the last frames from frames_ and gives the memory of their data back to the system.
+     * @param num_frames the new size of frames_
+     */
+    void RemoveFrames(size_t num_frames);
+
+    /** @return true if the frame is one the instance can still hand out, false if it is being drained by a resize */
+    bool IsActive(frame_id_t frame_id) const { return static_cast<size_t>(frame_id) < num_frames_; }
+
+    /** Position of this instance in instances_. */
+    size_t index_;
+    /** Number of frames the instance hands out. While shrinking, frames_ also holds the frames being drained. */
+    size_t num_frames_;
+    /** The replacement policy of the instance, to create a new replacer when the instance is resized. */
+    ReplacerType replacer_type_;
+    /** Chunks the frames of this instance are allocated in, in frame id order. */
+    std::vector<std::unique_ptr<FrameChunk>> chunks_;
+    /** Frames of this instance, indexed by frame id. */
+    std::vector<Frame *> frames_;
+    /** Page table for keeping track of the pages held by this instance, written under the latch only. */
+    PageTable<Frame> page_table_;
+    /** Replacer to find unpinned frames of this instance for replacement, it only knows the active frames. */
+    std::unique_ptr<Replacer> replacer_;
+    /** List of free frames of this instance. */
+    std::list<frame_id_t> free_list_;
+    /** Frames whose last unpin found the latch taken, whose access the replacer has yet to record. */
+    std::vector<frame_id_t> pending_accesses_;
+    /** Protects pending_accesses_, it is taken alone or after the latch. */
+    std::mutex pending_latch_;
+    /** Pages whose copy is being written by a flush. Their frames stay usable, but their disk pages cannot be read. */
+    std::unordered_set<page_id_t> flushing_pages_;
+    /** Notified whenever a page leaves flushing_pages_. */
+    std::condition_variable flush_done_;
+    /**
+     * This latch serializes the writers of the page table, and protects the replacer, the free list, the frames and
+     * the metadata of the instance's pages, except for the pins taken and released by hits. It is never held during
+     * disk I/O.
+     */
+    std::mutex latch_;
+    /** Counters of the instance, on their own cache lines since hits update them without the latch. */
+    BufferPoolCounters counters_;
+  };
+
+  /** Pin count of a frame that is being loaded or evicted and cannot be pinned. */
+  static constexpr int CLAIMED = -1;
+
+  /** @return the instance responsible for the given page */
+  BufferPoolInstance *GetInstance(page_id_t page_id) { return instances_[page_id % instances_.size()].get(); }
+
+  /**
+   * Grows or shrinks an instance to the given number of frames, see Resize.
+   * @param instance the instance to resize
+   * @param num_frames the new number of frames of the instance
+   */
+  void ResizeInstance(BufferPoolInstance *instance, size_t num_frames);
+
+  /**
+   * Replaces the replacer of an instance by one sized for its active frames. The unpinned active frames are handed
+   * over in eviction order, so the coldest frames stay the first victims.
+   * The caller must hold the instance latch.
+   * @param instance the instance whose replacer is replaced
+   */
+  void RebuildReplacer(BufferPoolInstance *instance);
+
+  /**
+   * Find and claim a frame of the instance that can hold a new page. With a strategy, a frame of its ring is recycled
+   * if possible. Otherwise the frame comes from the free list first and from the replacer next, and joins the ring.
+   * A recycled or victim frame still holds its old page, which LoadFrame evicts.
+   * The caller must hold the instance latch.
+   * @param instance the instance to find a frame in
+   * @param[out] frame_id id of the frame found
+   * @param strategy the ring of frames to recycle, nullptr for the shared pool
+   * @return false if every frame of the instance is pinned, true otherwise
+   */
+  bool FindFreeFrame(BufferPoolInstance *instance, frame_id_t *frame_id, BufferAccessStrategy *strategy);
+
+  /**
+   * Take back a frame of the strategy's ring that belongs to the instance and is unpinned.
+   * The caller must hold the instance latch.
+   * @param instance the instance to find a frame in
+   * @param[out] frame_id id of the frame recycled
+   * @param strategy the ring of frames to recycle
+   * @return false if the ring is not full yet or none of its frames can be recycled, true otherwise
+   */
+  bool RecycleRingFrame(BufferPoolInstance *instance, frame_id_t *frame_id, BufferAccessStrategy *strategy);
+
+  /**
+   * Pins a page if it is in the pool and its frame is not claimed, without taking the instance latch.
+   * @param instance the instance the page belongs to
+   * @param page_id id of the page
+   * @return the page pinned, nullptr if it has to be looked up under the latch
+   */
+  Page *TryPinHit(BufferPoolInstance *instance, page_id_t page_id);
+
+  /**
+   * Releases a pin on a frame. The last pin hands the frame back to the replacer if it is out of it, or records the
+   * access, right away if the instance latch is free and as a pending access otherwise.
+   * The caller must not hold the instance latch.
+   * @param instance the instance the frame belongs to
+   * @param frame the frame
+   * @param is_dirty true if the page was modified while pinned
+   * @return false if the frame was not pinned, true otherwise
+   */
+  bool ReleasePin(BufferPoolInstance *instance, BufferPoolInstance::Frame *frame, bool is_dirty);
+
+  /**
+   * Records the pending accesses of an instance in its replacer. The caller must hold the instance latch.
+   * @param instance the instance
+   */
+  void RecordPendingAccesses(BufferPoolInstance *instance);
+
+  /**
+   * Claims an unpinned frame, so that it can no longer be pinned until its pin count is set again.
+   * @param frame the frame
+   * @return false if the frame is pinned or already claimed, true otherwise
+   */
+  static bool ClaimFrame(BufferPoolInstance::Frame *frame);
+
+  /**
+   * Claims a frame taken out of the replacer. If it is pinned, it is marked out of the replacer instead, for its last
+   * unpin to hand it back.
+   * The caller must hold the instance latch.
+   * @param frame the frame
+   * @return false if the frame is pinned, true otherwise
+   */
+  static bool ClaimOrSkipFrame(BufferPoolInstance::Frame *frame);
+
+  /**
+   * Pin the page held by a frame that is not in I/O.
+   * The caller must hold the instance latch.
+   * @param instance the instance the frame belongs to
+   * @param frame_id id of the frame
+   * @return the page pinned
+   */
+  Page *PinFrame(BufferPoolInstance *instance, frame_id_t frame_id);
+
+  /**
+   * Install a page in a frame claimed by FindFreeFrame. The old page of the frame is written back if
+   * dirty, then the new page is read from disk or zeroed. The latch is released during the I/O, while the frame is
+   * marked in I/O and both the old and the new page stay mapped to it, so that fetchers of either page wait on
+   * io_done_ of this frame only.
+   * @param instance the instance the frame belongs to
+   * @param lock the held lock on the instance latch, held again on return
+   * @param frame_id id of the frame
+   * @param page_id id of the page to install
+   * @param read true to read the page from disk, false to zero it
+   * @param pin true to pin the page, false to leave it evictable
+   * @return the page installed, nullptr if it could not be read, in which case the frame is freed
+   */
+  Page *LoadFrame(BufferPoolInstance *instance, std::unique_lock<std::mutex> *lock, frame_id_t frame_id,
+                  page_id_t page_id, bool read, bool pin);
+
+  /**
+   * Points the page of a frame being loaded at its data: straight into the mapping of a read-only database file when
+   * the page is to be read and can be, at the frame's own data otherwise. The frame must be claimed.
+   * @param instance the instance the frame belongs to
+   * @param frame_id id of the frame
+   * @param page_id id of the page being loaded
+   * @param read true if the page is to be read
+   * @return true if the page is in place, false if it still has to be read or zeroed
+   */
+  bool SetFrameData(BufferPoolInstance *instance, frame_id_t frame_id, page_id_t page_id, bool read);
+
+  /**
+   * First half of LoadFrame: maps the new page to the claimed frame, marks it in I/O and writes the old page back if
+   * dirty. The new page can then be read into the frame without holding the latch.
+   * @param instance the instance the frame belongs to
+   * @param lock the held lock on the instance latch, released on return
+   * @param frame_id id of the frame
+   * @param page_id id of the page to install
+   * @return the id of the page the frame held before
+   */
+  page_id_t StartLoad(BufferPoolInstance *instance, std::unique_lock<std::mutex> *lock, frame_id_t frame_id,
+                      page_id_t page_id);
+
+  /**
+   * Second half of LoadFrame, once the new page is in the frame: evicts the old page and makes the new one available.
+   * @param instance the instance the frame belongs to
+   * @param lock the released lock on the instance latch, held on return
+   * @param frame_id id of the frame
+   * @param old_page_id id of the page the frame held before, as returned by StartLoad
+   * @param page_id id of the page installed
+   * @param pin true to pin the page, false to leave it evictable
+   * @param dirty true if the page differs from its copy on disk, as a new page on a recycled page id does
+   * @return the page installed
+   */
+  Page *FinishLoad(BufferPoolInstance *instance, std::unique_lock<std::mutex> *lock, frame_id_t frame_id,
+                   page_id_t old_page_id, page_id_t page_id, bool pin, bool dirty);
+
+  /**
+   * Second half of LoadFrame, once the new page failed to be read: evicts the old page and puts the frame, empty, on
+   * the free list.
+   * @param instance the instance the frame belongs to
+   * @param lock the released lock on the instance latch, held on return
+   * @param frame_id id of the frame
+   * @param old_page_id id of the page the frame held before, as returned by StartLoad
+   * @param page_id id of the page that failed to be read
+   */
+  void AbortLoad(BufferPoolInstance *instance, std::unique_lock<std::mutex> *lock, frame_id_t frame_id,
+                 page_id_t old_page_id, page_id_t page_id);
+
+  /**
+   * Body of the prefetch thread, loads the queued pages until StopPrefetchThread is called. Up to PREFETCH_BATCH_SIZE
+   * pages are read at once, asynchronously.
+   */
+  void RunPrefetchThread();
+
+  /** Stops the prefetch thread, if it is running, and drops the pending prefetches. */
+  void StopPrefetchThread();
+
+  /**
+   * Write a page back from a copy of its data, so that its frame can still be used or evicted during the write.
+   * The latch is released during the write.
+   * @param instance the instance the page belongs to
+   * @param lock the held lock on the instance latch, held again on return
+   * @param page_id id of the page to write
+   * @param background true for the background flush thread, which only writes the page if it is unpinned, dirty and
+   * not already being written
+   * @return false if the page was not written, true otherwise
+   */
+  bool FlushFrame(BufferPoolInstance *instance, std::unique_lock<std::mutex> *lock, page_id_t page_id, bool background);
+
+  /**
+   * First half of FlushFrame: copies the page and marks it as being written, after waiting for the I/O in progress on
+   * it unless background is true. Nothing may wait on a page marked by the caller in the meantime, so the caller must
+   * write its marked pages before calling it on a page in I/O.
+   * @param instance the instance the page belongs to
+   * @param lock the held lock on the instance latch, held again on return
+   * @param page_id id of the page to write
+   * @param background true to skip the page unless it is unpinned, dirty and not already being written
+   * @param[out] data buffer the page is copied into
+   * @return false if the page is not to be written, true otherwise
+   */
+  bool StartFlush(BufferPoolInstance *instance, std::unique_lock<std::mutex> *lock, page_id_t page_id, bool background,
+                  char *data);
+
+  /**
+   * Second half of FlushFrame: writes the copies of pages marked by StartFlush, consecutive pages together, then
+   * unmarks the pages. The caller must not hold any instance latch.
+   * @param batch the pages and their copies, cleared on return
+   * @param background true if written by the background flush thread
+   */
+  void WriteFlushBatch(std::vector<PageWrite> *batch, bool background);
+
+  /**
+   * Write back the coldest dirty pages of an instance until it has enough clean reusable frames.
+   * @param instance the instance to clean
+   * @param clean_frames the number of clean reusable frames to reach
+   */
+  void BackgroundFlush(BufferPoolInstance *instance, size_t clean_frames);
+
   /**
    * Grading function. Do not modify!
    * Invokes the callback function if it is not null.
@@ -114,15 +627,17 @@ class BufferPoolManager {
   /**
    * Fetch the requested page from the buffer pool.
    * @param page_id id of page to be fetched
-   * @return the requested page
+   * @param strategy the ring of frames to recycle on a miss, nullptr for the shared pool
+   * @return the requested page, nullptr if every frame is pinned or the page cannot be read
    */
-  Page *FetchPageImpl(page_id_t page_id);
+  Page *FetchPageImpl(page_id_t page_id, BufferAccessStrategy *strategy = nullptr);
 
   /**
    * Unpin the target page from the buffer pool.
    * @param page_id id of page to be unpinned
    * @param is_dirty true if the page should be marked as dirty, false otherwise
-   * @return false if the page pin count is <= 0 before this call, true otherwise
+   * @return false if the page pin count is <= 0 before this call, or if the page is marked as dirty while the database
+   * file is read-only, in which case it is unpinned clean; true otherwise
    */
   bool UnpinPageImpl(page_id_t page_id, bool is_dirty);
 
@@ -136,37 +651,58 @@ class BufferPoolManager {
   /**
    * Creates a new page in the buffer pool.
    * @param[out] page_id id of created page
+   * @param strategy the ring of frames to recycle, nullptr for the shared pool
+   * @param extent_allocator the extents to allocate the page in, nullptr to allocate it alone
    * @return nullptr if no new pages could be created, otherwise pointer to new page
    */
-  Page *NewPageImpl(page_id_t *page_id);
+  Page *NewPageImpl(page_id_t *page_id, BufferAccessStrategy *strategy = nullptr,
+                    ExtentAllocator *extent_allocator = nullptr);
 
   /**
    * Deletes a page from the buffer pool.
    * @param page_id id of page to be deleted
-   * @return false if the page exists but could not be deleted, true if the page didn't exist or deletion succeeded
+   * @return false if the page exists but could not be deleted or the database file is read-only, true if the page
+   * didn't exist or deletion succeeded
    */
   bool DeletePageImpl(page_id_t page_id);
 
   /**
-   * Flushes all the pages in the buffer pool to disk.
+   * Flushes all the pages in the buffer pool to disk and makes them durable, as a checkpoint needs. Pages are written
+   * in page id order, FLUSH_BATCH_SIZE at a time, with a single write per run of consecutive pages.
    */
   void FlushAllPagesImpl();
 
   /** Number of pages in the buffer pool. */
-  size_t pool_size_;
-  /** Array of buffer pool pages. */
-  Page *pages_;
+  std::atomic<size_t> pool_size_;
+  /** Serializes the resizes of the buffer pool. */
+  std::mutex resize_latch_;
   /** Pointer to the disk manager. */
   DiskManager *disk_manager_ __attribute__((__unused__));
   /** Pointer to the log manager. */
   LogManager *log_manager_ __attribute__((__unused__));
-  /** Page table for keeping track of buffer pool pages. */
-  std::unordered_map<page_id_t, frame_id_t> page_table_;
-  /** Replacer to find unpinned pages for replacement. */
-  Replacer *replacer_;
-  /** List of free pages. */
-  std::list<frame_id_t> free_list_;
-  /** This latch protects shared data structures. We recommend updating this comment to describe what it protects. */
-  std::mutex latch_;
+  /** Partitions of the buffer pool, a page with id P lives in instances_[P % instances_.size()]. */
+  std::vector<std::unique_ptr<BufferPoolInstance>> instances_;
+  /** Number of pages written back by evictions and explicit flushes. */
+  std::atomic<uint64_t> num_foreground_writes_{0};
+  /** Number of pages written back by the background flush thread. */
+  std::atomic<uint64_t> num_background_writes_{0};
+  /** The background flush thread, nullptr if it is not running. */
+  std::unique_ptr<std::thread> flush_thread_;
+  /** True while the background flush thread should keep running, protected by flush_thread_latch_. */
+  bool flush_thread_running_{false};
+  std::mutex flush_thread_latch_;
+  /** Notified to wake the background flush thread up when it should stop. */
+  std::condition_variable flush_thread_cv_;
+  /** Number of pages read by the prefetch thread. */
+  std::atomic<uint64_t> num_prefetches_{0};
+  /** The prefetch thread, started by the first prefetch, nullptr if it is not running. */
+  std::unique_ptr<std::thread> prefetch_thread_;
+  /** True while the prefetch thread should keep running, protected by prefetch_latch_. */
+  bool prefetch_running_{false};
+  /** Pages waiting to be prefetched, with the ring to load them into, protected by prefetch_latch_. */
+  std::deque<std::pair<page_id_t, std::shared_ptr<BufferAccessStrategy>>> prefetch_queue_;
+  std::mutex prefetch_latch_;
+  /** Notified when a page is queued or the prefetch thread should stop. */
+  std::condition_variable prefetch_cv_;
 };
 }  // namespace bustub
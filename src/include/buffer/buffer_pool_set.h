@@ -0,0 +1,103 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_set.h
+//
+// Identification: src/include/buffer/buffer_pool_set.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_pool_stats.h"
+
+namespace bustub {
+
+/** The classes of pages that can be given a buffer pool of their own. */
+enum class PageClass {
+  /** Pages of table heaps. */
+  HEAP = 0,
+  /** Pages of indexes. */
+  INDEX,
+  /** Temporary pages that executors spill intermediate results to. */
+  TEMP,
+};
+
+/** Number of page classes. */
+static constexpr size_t NUM_PAGE_CLASSES = 3;
+
+/**
+ * BufferPoolSet owns named buffer pools, each with its own size and replacement policy, over the same disk manager, and
+ * routes every page class to one of them. Giving indexes, table heaps and temporary pages separate pools keeps a burst
+ * of one class, such as a large spill, from evicting the pages of another.
+ *
+ * A page must only ever be accessed through the pool of its class, since the pools do not know about each other's
+ * pages. Pools are added and routed while setting the system up, before any page is accessed.
+ */
+class BufferPoolSet {
+ public:
+  /**
+   * Creates a new BufferPoolSet without any pool.
+   * @param disk_manager the disk manager shared by the pools
+   * @param log_manager the log manager shared by the pools (for testing only: nullptr = disable logging)
+   */
+  BufferPoolSet(DiskManager *disk_manager, LogManager *log_manager)
+      : disk_manager_(disk_manager), log_manager_(log_manager) {}
+
+  /**
+   * Adds a pool. Every page class that is not routed elsewhere uses the first pool added.
+   * @param name the name of the pool, unique in the set
+   * @param pool_size the size of the pool
+   * @param num_instances the number of instances to partition the pool into
+   * @param replacer_type the replacement policy of the pool
+   * @return the new pool
+   */
+  BufferPoolManager *AddPool(const std::string &name, size_t pool_size, size_t num_instances = 1,
+                             BufferPoolManager::ReplacerType replacer_type = BufferPoolManager::ReplacerType::LRU);
+
+  /** @return the pool with the given name, nullptr if there is none */
+  BufferPoolManager *GetPool(const std::string &name);
+
+  /** @return the pool the pages of the given class live in */
+  BufferPoolManager *GetPool(PageClass page_class);
+
+  /**
+   * Routes a page class to a pool.
+   * @param page_class the page class
+   * @param name the name of the pool, which must have been added
+   */
+  void Route(PageClass page_class, const std::string &name);
+
+  /**
+   * Flushes all the pages of every pool to disk and makes them durable, as a checkpoint needs. Every pool syncs the
+   * disk manager after writing its pages.
+   */
+  void FlushAllPages();
+
+  /** @return the name and a snapshot of the counters of every pool, in the order the pools were added */
+  std::vector<std::pair<std::string, BufferPoolStats>> GetStats();
+
+ private:
+  /** The disk manager shared by the pools. */
+  DiskManager *disk_manager_;
+  /** The log manager shared by the pools. */
+  LogManager *log_manager_;
+  /** Pools, in the order they were added, with their names. */
+  std::vector<std::pair<std::string, std::unique_ptr<BufferPoolManager>>> pools_;
+  /** Positions in pools_ of the pools by name. */
+  std::unordered_map<std::string, size_t> names_;
+  /** Position in pools_ of the pool of every page class. */
+  size_t routes_[NUM_PAGE_CLASSES] = {};
+};
+
+}  // namespace bustub
@@ -0,0 +1,97 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_stats.h
+//
+// Identification: src/include/buffer/buffer_pool_stats.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * How a page is accessed. The buffer pool does not know what its pages hold, so its statistics are broken down by
+ * access type instead of page type.
+ */
+enum class AccessType {
+  /** A fetch of a page in the shared pool. */
+  SHARED = 0,
+  /** A fetch through a BufferAccessStrategy, by a sequential scan or a bulk load. */
+  STRATEGY,
+  /** A read issued by the prefetch thread. */
+  PREFETCH,
+};
+
+/** Number of access types. */
+static constexpr size_t NUM_ACCESS_TYPES = 3;
+
+/** BufferPoolStats is a snapshot of the counters of a buffer pool, or of one of its instances. */
+struct BufferPoolStats {
+  /** @return number of accesses that found their page in the pool */
+  uint64_t GetHits() const;
+
+  /** @return number of accesses that had to read their page from disk */
+  uint64_t GetMisses() const;
+
+  /** @return the share of the accesses that were hits, 0 if there was no access */
+  double GetHitRatio() const;
+
+  /** Adds the counts of another snapshot to this one. */
+  BufferPoolStats &operator+=(const BufferPoolStats &other);
+
+  /** @return the snapshot as one line of "name=value" pairs */
+  std::string ToString() const;
+
+  /** Accesses that found their page in the pool, by access type. */
+  std::array<uint64_t, NUM_ACCESS_TYPES> hits_{};
+  /** Accesses that read their page from disk, by access type. */
+  std::array<uint64_t, NUM_ACCESS_TYPES> misses_{};
+  /** Pages created. */
+  uint64_t new_pages_{0};
+  /** Pages evicted to make room for another page. */
+  uint64_t evictions_{0};
+  /** Evicted pages that were dirty and written back first. */
+  uint64_t dirty_write_backs_{0};
+  /** Fetches and page creations that failed because every frame was pinned. */
+  uint64_t all_pinned_failures_{0};
+  /** Fetches that found their page and waited for its frame to be loaded or written back before pinning it. */
+  uint64_t pin_waits_{0};
+};
+
+/**
+ * BufferPoolCounters holds the counters a BufferPoolStats is a snapshot of. They are updated with relaxed atomic
+ * increments, from hits that hold no latch as well as under the instance latch, so a snapshot taken while the pool is
+ * in use is not a consistent cut, and a reset can lose increments made at the same time.
+ */
+struct alignas(CACHE_LINE_SIZE) BufferPoolCounters {
+  /** Adds one to a counter. */
+  static void Increment(std::atomic<uint64_t> *counter) { counter->fetch_add(1, std::memory_order_relaxed); }
+
+  /** @return the current values of the counters */
+  BufferPoolStats Snapshot() const;
+
+  /** Sets every counter back to zero. */
+  void Reset();
+
+  std::array<std::atomic<uint64_t>, NUM_ACCESS_TYPES> hits_{};
+  std::array<std::atomic<uint64_t>, NUM_ACCESS_TYPES> misses_{};
+  std::atomic<uint64_t> new_pages_{0};
+  std::atomic<uint64_t> evictions_{0};
+  std::atomic<uint64_t> dirty_write_backs_{0};
+  std::atomic<uint64_t> all_pinned_failures_{0};
+  std::atomic<uint64_t> pin_waits_{0};
+};
+
+}  // namespace bustub
@@ -12,23 +12,27 @@
 
 #pragma once
 
-#include <list>
+#include <atomic>
+#include <memory>
 #include <mutex>  // NOLINT
-#include <vector>
 
 #include "buffer/replacer.h"
 #include "common/config.h"
+#include "common/macros.h"
 
 namespace bustub {
 
 /**
  * ClockReplacer implements the clock replacement policy, which approximates the Least Recently Used policy.
+ * Pin and Unpin only flip per-frame atomic bits and never take a lock. Only Victim takes a latch, to sweep the clock
+ * hand over the frames.
  */
 class ClockReplacer : public Replacer {
  public:
   /**
    * Create a new ClockReplacer.
-   * @param num_pages the maximum number of pages the ClockReplacer will be required to store
+   * @param num_pages the maximum number of pages the ClockReplacer will be required to store, frame ids must be in
+   * [0, num_pages)
    */
   explicit ClockReplacer(size_t num_pages);
 
@@ -43,10 +47,26 @@ class ClockReplacer : public Replacer {
 
   void Unpin(frame_id_t frame_id) override;
 
+  bool Remove(frame_id_t frame_id) override;
+
   size_t Size() override;
 
  private:
-  // TODO(student): implement me!
+  /** Set iff the frame is unpinned and can be victimized. */
+  static constexpr uint8_t IN_CLOCK = 1;
+  /** Set when the frame is unpinned, cleared when the hand passes over it. */
+  static constexpr uint8_t REFERENCED = 2;
+
+  /** Number of frames in the clock. */
+  size_t num_pages_;
+  /** IN_CLOCK and REFERENCED bits of every frame. */
+  std::unique_ptr<std::atomic<uint8_t>[]> frames_;
+  /** Number of frames with the IN_CLOCK bit set. */
+  std::atomic<size_t> size_{0};
+  /** The frame the clock hand points at, only accessed by Victim. */
+  size_t hand_{0};
+  /** Serializes sweeps of the clock hand. */
+  std::mutex hand_latch_;
 };
 
 }  // namespace bustub
@@ -0,0 +1,62 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_arena.h
+//
+// Identification: src/include/buffer/frame_arena.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * FrameArena is one contiguous, zeroed allocation holding the data of a number of buffer pool frames, PAGE_SIZE bytes
+ * each and PAGE_SIZE-aligned. Keeping page data apart from the frame metadata means metadata scans do not pull page
+ * data into the cache. The arena is backed by huge pages when the system has some reserved, and is otherwise marked
+ * for transparent huge pages, so that a large pool needs few TLB entries.
+ */
+class FrameArena {
+ public:
+  /**
+   * Creates a new FrameArena.
+   * @param num_frames the number of frames to hold data for
+   */
+  explicit FrameArena(size_t num_frames);
+
+  FrameArena(const FrameArena &) = delete;
+  FrameArena &operator=(const FrameArena &) = delete;
+
+  ~FrameArena();
+
+  /** @return the data of the given frame */
+  char *GetFrameData(size_t frame) { return data_ + frame * PAGE_SIZE; }
+
+  /**
+   * Gives the memory of some frames back to the system. Their data reads as zeroes when they are touched again.
+   * @param first_frame the first frame to release
+   * @param num_frames the number of frames to release
+   */
+  void Release(size_t first_frame, size_t num_frames);
+
+  /** @return true if the arena is backed by reserved huge pages, false if it relies on transparent huge pages */
+  bool IsHugePageBacked() const { return huge_page_backed_; }
+
+ private:
+  /** Start of the mapping. */
+  char *data_{nullptr};
+  /** Length of the mapping, a multiple of the huge page size if huge_page_backed_ is true. */
+  size_t size_;
+  /** True if the mapping was made with MAP_HUGETLB. */
+  bool huge_page_backed_{false};
+};
+
+}  // namespace bustub
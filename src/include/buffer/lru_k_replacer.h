@@ -0,0 +1,93 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lru_k_replacer.h
+//
+// Identification: src/include/buffer/lru_k_replacer.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <mutex>  // NOLINT
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "buffer/replacer.h"
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * LRUKReplacer implements the LRU-K replacement policy.
+ *
+ * Every Pin counts as an access to the frame. Time is measured in accesses: each Pin advances a logical clock by one.
+ * An access that comes within correlated_reference_period of the frame's previous access is correlated with it, e.g.
+ * a scan reading every tuple of a page, and only refreshes the time of the last access. Any other access is a new
+ * reference and enters the frame's history of the last K references.
+ *
+ * The victim is the evictable frame with the largest backward K-distance, i.e. the oldest K-th most recent reference.
+ * Frames with fewer than K references have an infinite K-distance and are evicted first, least recently accessed
+ * first. A page touched once by a scan therefore goes before an index page that is referenced again and again.
+ */
+class LRUKReplacer : public Replacer {
+ public:
+  /**
+   * Create a new LRUKReplacer.
+   * @param num_pages the maximum number of pages the LRUKReplacer will be required to store, frame ids must be in
+   * [0, num_pages)
+   * @param k the number of references kept per frame
+   * @param correlated_reference_period accesses to a frame within this many accesses of its previous access are
+   * correlated with it
+   */
+  explicit LRUKReplacer(size_t num_pages, size_t k = LRUK_REPLACER_K,
+                        uint64_t correlated_reference_period = LRUK_CORRELATED_REFERENCE_PERIOD);
+
+  /**
+   * Destroys the LRUKReplacer.
+   */
+  ~LRUKReplacer() override;
+
+  bool Victim(frame_id_t *frame_id) override;
+
+  void Pin(frame_id_t frame_id) override;
+
+  void Unpin(frame_id_t frame_id) override;
+
+  bool Remove(frame_id_t frame_id) override;
+
+  size_t Size() override;
+
+ private:
+  /** Remove an evictable frame from the set it is in. The caller must hold latch_. */
+  void Unlink(frame_id_t frame_id);
+
+  /** @return the i-th most recent reference of the frame, i starting at 0 */
+  uint64_t &History(frame_id_t frame_id, size_t i) { return history_[frame_id * k_ + i]; }
+
+  size_t k_;
+  uint64_t correlated_reference_period_;
+  /** The logical clock, incremented on every access. */
+  uint64_t current_timestamp_{0};
+  /** The last k_ references of every frame, most recent first. */
+  std::vector<uint64_t> history_;
+  /** Number of valid entries in the history of every frame, at most k_. */
+  std::vector<size_t> num_references_;
+  /** Time of the last access of every frame, correlated or not. */
+  std::vector<uint64_t> last_access_;
+  /** evictable_[f] is true iff frame f is unpinned and can be victimized. */
+  std::vector<bool> evictable_;
+  /** Evictable frames with fewer than k_ references, ordered by last access. */
+  std::set<std::pair<uint64_t, frame_id_t>> cold_frames_;
+  /** Evictable frames with k_ references, ordered by their k-th most recent reference. */
+  std::set<std::pair<uint64_t, frame_id_t>> hot_frames_;
+  /** Protects all of the above. */
+  std::mutex latch_;
+};
+
+}  // namespace bustub
@@ -12,23 +12,26 @@
 
 #pragma once
 
-#include <list>
 #include <mutex>  // NOLINT
 #include <vector>
 
 #include "buffer/replacer.h"
 #include "common/config.h"
+#include "common/macros.h"
 
 namespace bustub {
 
 /**
  * LRUReplacer implements the lru replacement policy, which approximates the Least Recently Used policy.
+ * Unpinned frames are kept in an intrusive doubly-linked list threaded through per-frame arrays, so Victim, Pin and
+ * Unpin run in constant time regardless of the number of frames.
  */
 class LRUReplacer : public Replacer {
  public:
   /**
    * Create a new LRUReplacer.
-   * @param num_pages the maximum number of pages the LRUReplacer will be required to store
+   * @param num_pages the maximum number of pages the LRUReplacer will be required to store, frame ids must be in
+   * [0, num_pages)
    */
   explicit LRUReplacer(size_t num_pages);
 
@@ -43,12 +46,25 @@ class LRUReplacer : public Replacer {
 
   void Unpin(frame_id_t frame_id) override;
 
+  bool Remove(frame_id_t frame_id) override;
+
   size_t Size() override;
 
  private:
-  // TODO(student): implement me!
-  std::mutex lru_mutex;
-  std::list<frame_id_t> unpinned_frames;
+  /** Unlink a frame from the list of unpinned frames. The caller must hold lru_mutex_. */
+  void Unlink(frame_id_t frame_id);
+
+  /** Sentinel of the list, its id is one past the last frame id. */
+  frame_id_t head_;
+  /** Links of the list of unpinned frames, ordered from least to most recently unpinned. */
+  std::vector<frame_id_t> prev_;
+  std::vector<frame_id_t> next_;
+  /** in_list_[f] is true iff frame f is unpinned and can be victimized. */
+  std::vector<bool> in_list_;
+  /** Number of unpinned frames. */
+  size_t size_{0};
+  /** Protects all of the above. */
+  std::mutex lru_mutex_;
 };
 
 }  // namespace bustub
@@ -0,0 +1,200 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_table.h
+//
+// Identification: src/include/buffer/page_table.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * PageTable maps page ids to the frames holding them. It is an open addressing hash table with linear probing that
+ * allows a single writer and any number of lock-free readers: Insert and Erase must be serialized by the caller, Find
+ * may be called concurrently with them without any lock.
+ *
+ * A Find that races with a writer is only a hint. It can miss a page that is moved around by an Erase or copied into
+ * a bigger table, and it can return a frame that held the page a moment ago. Readers must therefore check the frame
+ * they get, and fall back to looking the page up again under the writers' latch when they get nothing. Find called by
+ * the writer is exact.
+ *
+ * @tparam FrameType the frame type, the table stores pointers to frames
+ */
+template <typename FrameType>
+class PageTable {
+ public:
+  /**
+   * Creates a new PageTable.
+   * @param num_frames the number of frames the table is expected to map pages to, the table grows as needed
+   */
+  explicit PageTable(size_t num_frames) {
+    size_t capacity = MIN_CAPACITY;
+    while (capacity < 4 * num_frames) {
+      capacity *= 2;
+    }
+    tables_.emplace_back(std::make_unique<Table>(capacity));
+    table_.store(tables_.back().get());
+  }
+
+  PageTable(const PageTable &) = delete;
+  PageTable &operator=(const PageTable &) = delete;
+
+  /**
+   * Looks up a page, without taking any lock.
+   * @param page_id the page to look up
+   * @return the frame of the page, nullptr if the page was not found
+   */
+  FrameType *Find(page_id_t page_id) const {
+    const Table &table = *table_.load(std::memory_order_acquire);
+    for (size_t i = table.Home(page_id);; i = (i + 1) & table.mask_) {
+      page_id_t slot_page_id = table.slots_[i].page_id_.load(std::memory_order_acquire);
+      if (slot_page_id == page_id) {
+        return table.slots_[i].frame_.load(std::memory_order_acquire);
+      }
+      if (slot_page_id == INVALID_PAGE_ID) {
+        return nullptr;
+      }
+    }
+  }
+
+  /**
+   * Maps a page to a frame, replacing its previous frame if the page is already mapped. Only called by the writer.
+   * @param page_id the page to map
+   * @param frame the frame holding the page
+   */
+  void Insert(page_id_t page_id, FrameType *frame) {
+    Table *table = table_.load(std::memory_order_relaxed);
+    if (2 * (size_ + 1) > table->mask_ + 1) {
+      table = Grow();
+    }
+    if (table->Put(page_id, frame)) {
+      size_++;
+    }
+  }
+
+  /**
+   * Removes the mapping of a page. Only called by the writer.
+   * @param page_id the page to remove
+   * @return true if the page was mapped, false otherwise
+   */
+  bool Erase(page_id_t page_id) {
+    Table &table = *table_.load(std::memory_order_relaxed);
+    size_t hole = table.Home(page_id);
+    while (table.slots_[hole].page_id_.load(std::memory_order_relaxed) != page_id) {
+      if (table.slots_[hole].page_id_.load(std::memory_order_relaxed) == INVALID_PAGE_ID) {
+        return false;
+      }
+      hole = (hole + 1) & table.mask_;
+    }
+
+    // Shift back the following pages of the cluster that cannot be found from their home slot once the hole is empty.
+    // A moved page is briefly in two slots, readers may find either.
+    for (size_t i = (hole + 1) & table.mask_;; i = (i + 1) & table.mask_) {
+      page_id_t moved_page_id = table.slots_[i].page_id_.load(std::memory_order_relaxed);
+      if (moved_page_id == INVALID_PAGE_ID) {
+        break;
+      }
+      size_t home = table.Home(moved_page_id);
+      bool reachable = hole <= i ? (hole < home && home <= i) : (hole < home || home <= i);
+      if (!reachable) {
+        table.slots_[hole].frame_.store(table.slots_[i].frame_.load(std::memory_order_relaxed),
+                                        std::memory_order_relaxed);
+        table.slots_[hole].page_id_.store(moved_page_id, std::memory_order_release);
+        hole = i;
+      }
+    }
+    table.slots_[hole].page_id_.store(INVALID_PAGE_ID, std::memory_order_release);
+    size_--;
+    return true;
+  }
+
+  /** @return the number of mapped pages. Only called by the writer. */
+  size_t Size() const { return size_; }
+
+  /**
+   * Calls a function on every mapping. Only called by the writer.
+   * @param f the function, called with the page id and the frame of every mapped page
+   */
+  template <typename F>
+  void ForEach(F f) const {
+    const Table &table = *table_.load(std::memory_order_relaxed);
+    for (size_t i = 0; i <= table.mask_; ++i) {
+      page_id_t page_id = table.slots_[i].page_id_.load(std::memory_order_relaxed);
+      if (page_id != INVALID_PAGE_ID) {
+        f(page_id, table.slots_[i].frame_.load(std::memory_order_relaxed));
+      }
+    }
+  }
+
+ private:
+  /** Capacity of the smallest table. */
+  static constexpr size_t MIN_CAPACITY = 16;
+
+  /** A slot of the table, empty if its page id is INVALID_PAGE_ID. */
+  struct Slot {
+    std::atomic<page_id_t> page_id_{INVALID_PAGE_ID};
+    std::atomic<FrameType *> frame_{nullptr};
+  };
+
+  /** The slots of the table, a power of two of them. */
+  struct Table {
+    explicit Table(size_t capacity) : mask_(capacity - 1), slots_(new Slot[capacity]) {}
+
+    /** @return the slot the probe for a page starts at */
+    size_t Home(page_id_t page_id) const {
+      // Fibonacci hashing spreads the page ids an instance gets, which are often evenly strided.
+      return (static_cast<uint64_t>(static_cast<uint32_t>(page_id)) * 0x9E3779B97F4A7C15ULL >> 32) & mask_;
+    }
+
+    /** Maps a page to a frame, @return true if the page was not mapped before */
+    bool Put(page_id_t page_id, FrameType *frame) {
+      for (size_t i = Home(page_id);; i = (i + 1) & mask_) {
+        page_id_t slot_page_id = slots_[i].page_id_.load(std::memory_order_relaxed);
+        if (slot_page_id == page_id) {
+          slots_[i].frame_.store(frame, std::memory_order_release);
+          return false;
+        }
+        if (slot_page_id == INVALID_PAGE_ID) {
+          slots_[i].frame_.store(frame, std::memory_order_relaxed);
+          slots_[i].page_id_.store(page_id, std::memory_order_release);
+          return true;
+        }
+      }
+    }
+
+    size_t mask_;
+    std::unique_ptr<Slot[]> slots_;
+  };
+
+  /** Copies the mappings into a table twice as big and publishes it. @return the new table */
+  Table *Grow() {
+    const Table &old_table = *table_.load(std::memory_order_relaxed);
+    tables_.emplace_back(std::make_unique<Table>(2 * (old_table.mask_ + 1)));
+    Table *table = tables_.back().get();
+    ForEach([table](page_id_t page_id, FrameType *frame) { table->Put(page_id, frame); });
+    table_.store(table, std::memory_order_release);
+    return table;
+  }
+
+  /** The current table. */
+  std::atomic<Table *> table_;
+  /** Every table used so far. Replaced tables are kept, because readers may still be probing them. */
+  std::vector<std::unique_ptr<Table>> tables_;
+  /** Number of mapped pages. */
+  size_t size_{0};
+};
+
+}  // namespace bustub
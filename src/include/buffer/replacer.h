@@ -43,8 +43,24 @@ class Replacer {
    */
   virtual void Unpin(frame_id_t frame_id) = 0;
 
+  /**
+   * Removes an unpinned frame from the replacer, as if it had been picked as the victim.
+   * @param frame_id the id of the frame to remove
+   * @return true if the frame was unpinned and got removed, false otherwise
+   */
+  virtual bool Remove(frame_id_t frame_id) = 0;
+
   /** @return the number of elements in the replacer that can be victimized */
   virtual size_t Size() = 0;
+
+  /**
+   * Called by the buffer pool when a frame gets a new page. Replacers that keep a history of pages rather than frames
+   * override it, the others ignore it.
+   * @param frame_id the id of the frame
+   * @param old_page_id the page the frame held until now, which was evicted, INVALID_PAGE_ID if the frame was free
+   * @param page_id the page the frame holds from now on, INVALID_PAGE_ID if the frame becomes free
+   */
+  virtual void ReplacePage(frame_id_t frame_id, page_id_t old_page_id, page_id_t page_id) {}
 };
 
 }  // namespace bustub
@@ -7,6 +7,7 @@
 #include <vector>
 
 #include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_pool_set.h"
 #include "catalog/schema.h"
 #include "storage/index/b_plus_tree_index.h"
 #include "storage/index/index.h"
@@ -69,7 +70,28 @@ class Catalog {
       : bpm_{bpm}, lock_manager_{lock_manager}, log_manager_{log_manager} {}
 
   /**
-   * Create a new table and return its metadata.
+   * Creates a new catalog object whose tables, indexes and temporary pages live in the pools their page classes are
+   * routed to.
+   * @param buffer_pools the buffer pools backing tables created by this catalog
+   * @param lock_manager the lock manager in use by the system
+   * @param log_manager the log manager in use by the system
+   */
+  Catalog(BufferPoolSet *buffer_pools, LockManager *lock_manager, LogManager *log_manager)
+      : bpm_{buffer_pools->GetPool(PageClass::HEAP)},
+        buffer_pools_{buffer_pools},
+        lock_manager_{lock_manager},
+        log_manager_{log_manager} {}
+
+  /**
+   * @param page_class the class of the pages
+   * @return the buffer pool that pages of the given class live in, the catalog's pool if it has no buffer pool set
+   */
+  BufferPoolManager *GetBufferPool(PageClass page_class) {
+    return buffer_pools_ != nullptr ? buffer_pools_->GetPool(page_class) : bpm_;
+  }
+
+  /**
+   * Create a new table, whose heap lives in GetBufferPool(PageClass::HEAP), and return its metadata.
    * @param txn the transaction in which the table is being created
    * @param table_name the name of the new table
    * @param schema the schema of the new table
@@ -87,7 +109,8 @@ class Catalog {
   TableMetadata *GetTable(table_oid_t table_oid) { return nullptr; }
 
   /**
-   * Create a new index, populate existing data of the table and return its metadata.
+   * Create a new index, whose pages live in GetBufferPool(PageClass::INDEX), populate existing data of the table and
+   * return its metadata.
    * @param txn the transaction in which the table is being created
    * @param index_name the name of the new index
    * @param table_name the name of the table
@@ -112,6 +135,8 @@ class Catalog {
 
  private:
   [[maybe_unused]] BufferPoolManager *bpm_;
+  /** The pools of the page classes, nullptr if every page lives in bpm_. */
+  BufferPoolSet *buffer_pools_{nullptr};
   [[maybe_unused]] LockManager *lock_manager_;
   [[maybe_unused]] LogManager *log_manager_;
 
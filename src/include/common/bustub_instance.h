@@ -13,6 +13,7 @@
 #include <string>
 
 #include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_pool_set.h"
 #include "common/config.h"
 #include "concurrency/lock_manager.h"
 #include "recovery/checkpoint_manager.h"
@@ -32,14 +33,16 @@ class BustubInstance {
     // log related
     log_manager_ = new LogManager(disk_manager_);
 
-    buffer_pool_manager_ = new BufferPoolManager(BUFFER_POOL_SIZE, disk_manager_, log_manager_);
+    // Every page class uses the default pool until it is routed to a pool of its own with buffer_pools_.
+    buffer_pools_ = new BufferPoolSet(disk_manager_, log_manager_);
+    buffer_pool_manager_ = buffer_pools_->AddPool("default", BUFFER_POOL_SIZE);
 
     // txn related
     lock_manager_ = new LockManager();
     transaction_manager_ = new TransactionManager(lock_manager_, log_manager_);
 
     // checkpoints
-    checkpoint_manager_ = new CheckpointManager(transaction_manager_, log_manager_, buffer_pool_manager_);
+    checkpoint_manager_ = new CheckpointManager(transaction_manager_, log_manager_, buffer_pools_);
   }
 
   ~BustubInstance() {
@@ -48,13 +51,14 @@ class BustubInstance {
     }
     delete checkpoint_manager_;
     delete log_manager_;
-    delete buffer_pool_manager_;
+    delete buffer_pools_;
     delete lock_manager_;
     delete transaction_manager_;
     delete disk_manager_;
   }
 
   DiskManager *disk_manager_;
+  BufferPoolSet *buffer_pools_;
   BufferPoolManager *buffer_pool_manager_;
   LockManager *lock_manager_;
   TransactionManager *transaction_manager_;
@@ -27,6 +27,9 @@ extern std::atomic<bool> enable_logging;
 /** If ENABLE_LOGGING is true, the log should be flushed to disk every LOG_TIMEOUT. */
 extern std::chrono::duration<int64_t> log_timeout;
 
+/** The background flush thread of the buffer pool wakes up every BGWRITER_INTERVAL milliseconds. */
+extern std::chrono::milliseconds bgwriter_interval;
+
 static constexpr int INVALID_PAGE_ID = -1;                                    // invalid page id
 static constexpr int INVALID_TXN_ID = -1;                                     // invalid transaction id
 static constexpr int INVALID_LSN = -1;                                        // invalid log sequence number
@@ -35,6 +38,20 @@ static constexpr int PAGE_SIZE = 4096;                                        //
 static constexpr int BUFFER_POOL_SIZE = 10;                                   // size of buffer pool
 static constexpr int LOG_BUFFER_SIZE = ((BUFFER_POOL_SIZE + 1) * PAGE_SIZE);  // size of a log buffer in byte
 static constexpr int BUCKET_SIZE = 50;                                        // size of extendible hash bucket
+static constexpr int LRUK_REPLACER_K = 2;                                     // lookback window for lru-k replacer
+static constexpr int LRUK_CORRELATED_REFERENCE_PERIOD = 10;                   // correlated accesses, in frame accesses
+static constexpr int SCAN_RING_SIZE = 32;                                     // frames recycled by a sequential scan
+static constexpr int BULK_INSERT_RING_SIZE = 64;                              // frames recycled by a bulk insert
+static constexpr int BGWRITER_CLEAN_FRAMES = 4;                               // clean frames kept per pool instance
+static constexpr int PREFETCH_QUEUE_SIZE = 256;                               // pending prefetches per buffer pool
+static constexpr int TABLE_READ_AHEAD_WINDOW = 8;                             // pages prefetched ahead of a table scan
+static constexpr int PREFETCH_BATCH_SIZE = 16;                                // prefetch reads in flight at once
+static constexpr int CACHE_LINE_SIZE = 64;                                    // size of a cpu cache line in byte
+static constexpr int ASYNC_IO_QUEUE_DEPTH = 64;                               // page I/Os in flight per disk manager
+static constexpr int ASYNC_IO_THREADS = 4;                                    // threads emulating async I/O
+static constexpr int FLUSH_BATCH_SIZE = 64;                                   // pages written back together
+static constexpr int EXTENT_SIZE = 64;                                        // pages a table reserves at once
+static constexpr int PREALLOCATION_SIZE = 4096;                               // pages the db file space grows by
 
 using frame_id_t = int32_t;    // frame id type
 using page_id_t = int32_t;     // page id type
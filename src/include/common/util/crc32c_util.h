@@ -0,0 +1,41 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// crc32c_util.h
+//
+// Identification: src/include/common/util/crc32c_util.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace bustub {
+
+/**
+ * Crc32cUtil computes CRC32C (Castagnoli) checksums, with the SSE4.2 crc32 instruction when the CPU has it and with a
+ * lookup table otherwise.
+ */
+class Crc32cUtil {
+ public:
+  /**
+   * @param data the bytes to checksum
+   * @param length the number of bytes
+   * @return the CRC32C of the bytes
+   */
+  static uint32_t Crc32c(const char *data, size_t length);
+
+  /** @return true if checksums are computed by the CPU's crc32 instruction */
+  static bool IsHardwareAccelerated();
+
+ private:
+  static uint32_t Crc32cHardware(uint32_t crc, const char *data, size_t length);
+  static uint32_t Crc32cSoftware(uint32_t crc, const char *data, size_t length);
+};
+
+}  // namespace bustub
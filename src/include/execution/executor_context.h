@@ -51,6 +51,11 @@ class ExecutorContext {
   /** @return the buffer pool manager */
   BufferPoolManager *GetBufferPoolManager() { return bpm_; }
 
+  /** @return the buffer pool manager for pages of the given class, such as the TmpTuplePages executors spill to */
+  BufferPoolManager *GetBufferPoolManager(PageClass page_class) {
+    return catalog_ != nullptr ? catalog_->GetBufferPool(page_class) : bpm_;
+  }
+
   /** @return the log manager - don't worry about it for now */
   LogManager *GetLogManager() { return nullptr; }
 
@@ -12,7 +12,7 @@
 
 #pragma once
 
-#include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_pool_set.h"
 #include "concurrency/transaction_manager.h"
 #include "recovery/log_manager.h"
 
@@ -23,11 +23,8 @@ namespace bustub {
  */
 class CheckpointManager {
  public:
-  CheckpointManager(TransactionManager *transaction_manager, LogManager *log_manager,
-                    BufferPoolManager *buffer_pool_manager)
-      : transaction_manager_(transaction_manager),
-        log_manager_(log_manager),
-        buffer_pool_manager_(buffer_pool_manager) {}
+  CheckpointManager(TransactionManager *transaction_manager, LogManager *log_manager, BufferPoolSet *buffer_pools)
+      : transaction_manager_(transaction_manager), log_manager_(log_manager), buffer_pools_(buffer_pools) {}
 
   ~CheckpointManager() = default;
 
@@ -37,7 +34,7 @@ class CheckpointManager {
  private:
   TransactionManager *transaction_manager_ __attribute__((__unused__));
   LogManager *log_manager_ __attribute__((__unused__));
-  BufferPoolManager *buffer_pool_manager_ __attribute__((__unused__));
+  BufferPoolSet *buffer_pools_ __attribute__((__unused__));
 };
 
 }  // namespace bustub
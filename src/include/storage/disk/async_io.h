@@ -0,0 +1,197 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// async_io.h
+//
+// Identification: src/include/storage/disk/async_io.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <condition_variable>  // NOLINT
+#include <deque>
+#include <functional>
+#include <future>  // NOLINT
+#include <memory>
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * Reads a page with positional I/O, which any number of threads may do at once on the same file. The part of the page
+ * past the end of the file reads as zeroes.
+ * @param fd the file
+ * @param page_id id of the page
+ * @param[out] page_data output buffer
+ * @return false on an I/O error, true otherwise
+ */
+bool ReadPageAt(int fd, page_id_t page_id, char *page_data);
+
+/**
+ * Writes a page with positional I/O, which any number of threads may do at once on the same file.
+ * @param fd the file
+ * @param page_id id of the page
+ * @param page_data raw page data
+ * @return false on an I/O error, true otherwise
+ */
+bool WritePageAt(int fd, page_id_t page_id, const char *page_data);
+
+/**
+ * Writes pages with consecutive ids with positional vectored I/O, in a single write if there are at most IOV_MAX.
+ * @param fd the file
+ * @param first_page_id id of the first page
+ * @param pages raw data of the pages, in page id order
+ * @param num_pages number of pages
+ * @return false on an I/O error, true otherwise
+ */
+bool WritePagesAt(int fd, page_id_t first_page_id, const char *const *pages, size_t num_pages);
+
+/** A page read or write submitted to an AsyncIO. */
+struct AsyncIORequest {
+  /** True to write the page, false to read it. */
+  bool is_write_;
+  /** The page to read or write. */
+  page_id_t page_id_;
+  /** The page data, which must stay valid until the request completes. */
+  char *data_;
+  /** Fulfilled when the request completes, with false on an I/O error or a read its check rejected. */
+  std::promise<bool> done_;
+};
+
+/**
+ * Checks the data of a completed read, on the thread completing it.
+ * @return false to fail the read
+ */
+using ReadCompletionHandler = std::function<bool(page_id_t page_id, char *page_data)>;
+
+/** Takes note of a successful write, on the thread completing it, before the submitter learns of it. */
+using WriteCompletionHandler = std::function<void(page_id_t page_id, const char *page_data)>;
+
+/**
+ * AsyncIO performs page reads and writes on a file without blocking their submitter, with many of them in flight at
+ * once. Requests complete in any order. Destroying an AsyncIO waits for the requests in flight.
+ */
+class AsyncIO {
+ public:
+  virtual ~AsyncIO() = default;
+
+  /**
+   * Starts a request. Blocks only while ASYNC_IO_QUEUE_DEPTH requests are already in flight.
+   * @param request the request, completed through its promise
+   */
+  virtual void Submit(std::unique_ptr<AsyncIORequest> request) = 0;
+
+ protected:
+  AsyncIO(int fd, ReadCompletionHandler on_read, WriteCompletionHandler on_write)
+      : fd_(fd), on_read_(std::move(on_read)), on_write_(std::move(on_write)) {}
+
+  /** Performs a request synchronously and completes it. */
+  void Complete(std::unique_ptr<AsyncIORequest> request);
+
+  /** Completes a request whose I/O is done, running the read check or the write handler if it succeeded. */
+  void Finish(std::unique_ptr<AsyncIORequest> request, bool succeeded);
+
+  /** The file. */
+  int fd_;
+  /** Checks the data of successful reads, if set. */
+  ReadCompletionHandler on_read_;
+  /** Takes note of successful writes, if set. */
+  WriteCompletionHandler on_write_;
+};
+
+/** IoUringAsyncIO submits requests to an io_uring, whose completions are reaped by a dedicated thread. */
+class IoUringAsyncIO : public AsyncIO {
+ public:
+  /**
+   * Sets up an io_uring for a file.
+   * @param fd the file
+   * @param on_read the check of the data of every read, if any
+   * @param on_write the handler of every successful write, if any
+   * @return the new IoUringAsyncIO, nullptr if the kernel does not support io_uring
+   */
+  static std::unique_ptr<IoUringAsyncIO> Create(int fd, ReadCompletionHandler on_read = nullptr,
+                                                WriteCompletionHandler on_write = nullptr);
+
+  ~IoUringAsyncIO() override;
+
+  void Submit(std::unique_ptr<AsyncIORequest> request) override;
+
+ private:
+  IoUringAsyncIO(int fd, ReadCompletionHandler on_read, WriteCompletionHandler on_write)
+      : AsyncIO(fd, std::move(on_read), std::move(on_write)) {}
+
+  /** Queues a submission and enters the kernel. The caller must hold latch_. */
+  void SubmitEntry(uint8_t opcode, AsyncIORequest *request);
+
+  /** Body of the completion thread, completes requests until the ring is stopped and drained. */
+  void ReapCompletions();
+
+  /** The io_uring, -1 before it is set up. */
+  int ring_fd_{-1};
+  /** Mappings of the submission ring, the completion ring and the submission entries, with their lengths. */
+  void *sq_ring_{nullptr};
+  size_t sq_ring_size_{0};
+  void *cq_ring_{nullptr};
+  size_t cq_ring_size_{0};
+  void *sqes_{nullptr};
+  size_t sqes_size_{0};
+  /** Pointers into the rings, as described by the offsets io_uring_setup returns. */
+  unsigned *sq_tail_{nullptr};
+  unsigned *sq_mask_{nullptr};
+  unsigned *sq_array_{nullptr};
+  unsigned *cq_head_{nullptr};
+  unsigned *cq_tail_{nullptr};
+  unsigned *cq_mask_{nullptr};
+  void *cqes_{nullptr};
+  /** Number of requests submitted and not completed yet, protected by latch_. */
+  size_t num_in_flight_{0};
+  /** True once the ring is being torn down, protected by latch_. */
+  bool stopping_{false};
+  /** Serializes submissions. */
+  std::mutex latch_;
+  /** Notified when a request completes. */
+  std::condition_variable completed_;
+  /** The completion thread. */
+  std::unique_ptr<std::thread> completion_thread_;
+};
+
+/** ThreadPoolAsyncIO emulates asynchronous I/O with a pool of threads doing positional I/O. */
+class ThreadPoolAsyncIO : public AsyncIO {
+ public:
+  /**
+   * Starts the threads.
+   * @param fd the file
+   * @param num_threads the number of threads, hence of requests performed at once
+   * @param on_read the check of the data of every read, if any
+   * @param on_write the handler of every successful write, if any
+   */
+  ThreadPoolAsyncIO(int fd, size_t num_threads, ReadCompletionHandler on_read = nullptr,
+                    WriteCompletionHandler on_write = nullptr);
+
+  ~ThreadPoolAsyncIO() override;
+
+  void Submit(std::unique_ptr<AsyncIORequest> request) override;
+
+ private:
+  /** Requests waiting for a thread, protected by latch_. */
+  std::deque<std::unique_ptr<AsyncIORequest>> queue_;
+  /** True once the threads should stop, protected by latch_. */
+  bool stopping_{false};
+  std::mutex latch_;
+  /** Notified when a request is queued or the threads should stop. */
+  std::condition_variable queued_;
+  /** Notified when a request is taken off the queue. */
+  std::condition_variable dequeued_;
+  std::vector<std::thread> threads_;
+};
+
+}  // namespace bustub
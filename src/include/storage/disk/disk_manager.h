@@ -14,29 +14,115 @@
 
 #include <atomic>
 #include <fstream>
+#include <functional>
 #include <future>  // NOLINT
+#include <memory>
+#include <mutex>  // NOLINT
+#include <set>
+#include <shared_mutex>  // NOLINT
 #include <string>
+#include <vector>
 
 #include "common/config.h"
+#include "storage/disk/async_io.h"
 
 namespace bustub {
 
+/** How a DiskManager reads and writes the database file. */
+enum class PageIOMode {
+  /** Through the kernel page cache. */
+  BUFFERED,
+  /**
+   * With O_DIRECT, bypassing the page cache so pages are cached by the buffer pool only. Buffers not aligned to
+   * PAGE_SIZE go through an aligned copy. Falls back to BUFFERED if the file system does not support O_DIRECT.
+   */
+  DIRECT,
+  /**
+   * Read-only, for replicas that only serve reads: the database file, which must exist, is opened read-only and mapped
+   * into memory, so that the buffer pool can hand out pages straight from the mapping. Nothing is ever written.
+   */
+  MMAP_READ_ONLY,
+};
+
+/** How a DiskManager performs asynchronous page I/O. */
+enum class AsyncIOBackend {
+  /** Through an io_uring, or with THREAD_POOL if the kernel does not support io_uring. */
+  IO_URING,
+  /** With a pool of ASYNC_IO_THREADS threads doing synchronous I/O. */
+  THREAD_POOL,
+};
+
+/** A page to write with DiskManager::WritePages. */
+struct PageWrite {
+  /** id of the page */
+  page_id_t page_id_;
+  /** raw page data */
+  const char *data_;
+};
+
+/** What a DiskManager does with checksums, and with a page read from disk that does not match its checksum. */
+enum class ChecksumPolicy {
+  /** Neither record nor verify checksums. */
+  NONE,
+  /** Log the mismatch and return the page as read. */
+  LOG,
+  /** Fail the read. */
+  FAIL,
+  /** Have the repair handler rebuild the page, e.g. from the log, and fail the read if it cannot. */
+  REPAIR,
+};
+
+/**
+ * Rebuilds a page whose checksum does not match.
+ * @return true if page_data now holds the page, which the DiskManager then writes back
+ */
+using PageRepairHandler = std::function<bool(page_id_t page_id, char *page_data)>;
+
 /**
  * DiskManager takes care of the allocation and deallocation of pages within a database. It performs the reading and
  * writing of pages to and from disk, providing a logical file layer within the context of a database management system.
+ *
+ * Pages are read and written with positional I/O on the database file, which shares no file position between calls,
+ * so any number of threads may read and write pages concurrently. Concurrent accesses to the same page must still be
+ * serialized by the caller.
+ *
+ * Pages can also be read and written asynchronously, with up to ASYNC_IO_QUEUE_DEPTH requests in flight, which fast
+ * devices need to reach their throughput. The asynchronous backend is set up on first use.
+ *
+ * Which page ids are allocated is recorded in an allocation bitmap, one bit per page, kept in bitmap pages of its own
+ * file next to the database file, so that page ids keep matching page positions in the database file. Deallocated
+ * pages are reused by later allocations, and the next page id survives a restart. Pages can also be allocated in
+ * extents of consecutive pages, which keep the pages of a table together in the file however many tables grow at
+ * once. The file space of new pages is preallocated PREALLOCATION_SIZE pages at a time, so that the file system lays
+ * them out contiguously whatever order they are first written in.
+ *
+ * Every page written carries a CRC32C checksum, verified when the page is read back to catch silent corruption. Page
+ * layouts leave no room for it in the page header, so checksums are kept in a file of their own next to the database
+ * file, and in memory. The page and its checksum reach the disk in two writes, so the file keeps two checksums per
+ * page, the one before the write of the page and the one after it, and is synced before the page is written. Whether
+ * a crash or an I/O error leaves the page as it was or as written, it matches one of them and passes the check, while
+ * a page matching neither is corrupted. Once the write has completed the previous checksum is dropped, and so it is
+ * from the file once the page is synced.
  */
 class DiskManager {
  public:
   /**
    * Creates a new disk manager that writes to the specified database file.
    * @param db_file the file name of the database file to write to
+   * @param page_io_mode how to read and write the database file
+   * @param async_io_backend how to perform asynchronous page I/O
    */
-  explicit DiskManager(const std::string &db_file);
+  explicit DiskManager(const std::string &db_file, PageIOMode page_io_mode = PageIOMode::BUFFERED,
+                       AsyncIOBackend async_io_backend = AsyncIOBackend::IO_URING);
+
+  DiskManager(const DiskManager &) = delete;
+  DiskManager &operator=(const DiskManager &) = delete;
 
-  ~DiskManager() = default;
+  /** Closes the database file if ShutDown was not called. */
+  ~DiskManager();
 
   /**
-   * Shut down the disk manager and close all the file resources.
+   * Shut down the disk manager and close all the file resources, syncing the pages written and their checksums.
    */
   void ShutDown();
 
@@ -47,20 +133,100 @@ class DiskManager {
    */
   void WritePage(page_id_t page_id, const char *page_data);
 
+  /**
+   * Write several pages to the database file. Pages with consecutive ids are written together, with a single
+   * vectored write per run.
+   * @param pages the pages to write, in any order, the last write of a page listed twice wins
+   */
+  void WritePages(std::vector<PageWrite> pages);
+
   /**
    * Read a page from the database file.
    * @param page_id id of the page
    * @param[out] page_data output buffer
+   * @return false on an I/O error or on a checksum mismatch the checksum policy does not let through
+   */
+  bool ReadPage(page_id_t page_id, char *page_data);
+
+  /**
+   * Start writing a page to the database file, without waiting for the write.
+   * @param page_id id of the page
+   * @param page_data raw page data, which must stay valid and unchanged until the write completes
+   * @return a future that becomes ready when the write completes, with false on an I/O error
+   */
+  std::future<bool> WritePageAsync(page_id_t page_id, const char *page_data);
+
+  /**
+   * Start reading a page from the database file, without waiting for the read.
+   * @param page_id id of the page
+   * @param[out] page_data output buffer, which must stay valid until the read completes
+   * @return a future that becomes ready when the read completes, with what ReadPage would return
+   */
+  std::future<bool> ReadPageAsync(page_id_t page_id, char *page_data);
+
+  /**
+   * Sets what to do with checksums, LOG by default.
+   * @param checksum_policy the policy
+   * @param repair_handler rebuilds corrupted pages under the REPAIR policy
+   */
+  void SetChecksumPolicy(ChecksumPolicy checksum_policy, PageRepairHandler repair_handler = nullptr);
+
+  /** @return the number of pages read that did not match their checksum */
+  int GetNumChecksumFailures() const;
+
+  /** @return how the database file is read and written, BUFFERED if DIRECT was asked for but unsupported */
+  inline PageIOMode GetPageIOMode() { return page_io_mode_; }
+
+  /** @return true if the database file is read-only, and pages can be read from its mapping */
+  inline bool IsReadOnly() { return page_io_mode_ == PageIOMode::MMAP_READ_ONLY; }
+
+  /**
+   * Get a page in the mapping of a read-only database file, without copying it.
+   * @param page_id id of the page
+   * @return the page data, which stays valid as long as the DiskManager, or nullptr if the database file is not
+   * mapped, the page lies past its end or does not match its checksum, in which case ReadPage applies the checksum
+   * policy to a copy
+   */
+  const char *GetMappedPage(page_id_t page_id);
+
+  /**
+   * Hint that pages of a read-only database file will be read soon, so that the kernel starts reading them.
+   * @param page_id id of the first page
+   * @param num_pages number of pages
+   */
+  void AdviseWillNeed(page_id_t page_id, size_t num_pages);
+
+  /**
+   * Hint that the mapping of a read-only database file is read sequentially, until the matching
+   * EndSequentialAccess. The kernel then reads ahead aggressively and drops the pages read early.
    */
-  void ReadPage(page_id_t page_id, char *page_data);
+  void BeginSequentialAccess();
+
+  /** Ends the sequential access started by BeginSequentialAccess, the mapping is read as usual once all have ended. */
+  void EndSequentialAccess();
+
+  /** @return the backend performing asynchronous page I/O, THREAD_POOL if io_uring was asked for but unsupported */
+  AsyncIOBackend GetAsyncIOBackend();
 
   /**
-   * Flush the entire log buffer into disk.
+   * Make the page writes completed so far durable, with fdatasync on the database file. Page writes are not durable
+   * until then, so write-back costs no more than a write; checkpoints call Sync once after writing their pages.
+   */
+  void Sync();
+
+  /**
+   * Write the entire log buffer into the log file. The log is not durable until SyncLog.
    * @param log_data raw log data
    * @param size size of log entry
    */
   void WriteLog(char *log_data, int size);
 
+  /**
+   * Make the log written so far durable, with fdatasync on the log file. The log must be synced before the changes it
+   * records are considered committed, or before the pages they touch are written.
+   */
+  void SyncLog();
+
   /**
    * Read a log entry from the log file.
    * @param[out] log_data output buffer
@@ -68,20 +234,34 @@ class DiskManager {
    * @param offset offset of the log entry in the file
    * @return true if the read was successful, false otherwise
    */
-  bool ReadLog(char *log_data, int size, int offset);
+  bool ReadLog(char *log_data, int size, int64_t offset);
 
   /**
-   * Allocate a page on disk.
+   * Allocate a page on disk, reusing the deallocated page closest to a neighbor if there is one, and extending the
+   * database file otherwise.
+   * @param near id of a page the new page should be close to, the last allocated page if INVALID_PAGE_ID
    * @return the id of the allocated page
    */
-  page_id_t AllocatePage();
+  page_id_t AllocatePage(page_id_t near = INVALID_PAGE_ID);
 
   /**
-   * Deallocate a page on disk.
+   * Allocate a run of consecutive pages on disk, an extent, in the first run of deallocated pages long enough if there
+   * is one, and extending the database file otherwise. Deallocated pages at the end of the file start an extent that
+   * extends it. Pages of the extent are deallocated one by one.
+   * @param num_pages the number of pages
+   * @return the id of the first page of the extent, INVALID_PAGE_ID if the database file is read-only
+   */
+  page_id_t AllocateExtent(size_t num_pages);
+
+  /**
+   * Deallocate a page on disk, so that a later allocation can reuse it.
    * @param page_id id of the page to deallocate
    */
   void DeallocatePage(page_id_t page_id);
 
+  /** @return the number of deallocated pages waiting to be reused */
+  size_t GetNumFreePages();
+
   /** @return the number of disk flushes */
   int GetNumFlushes() const;
 
@@ -91,6 +271,9 @@ class DiskManager {
   /** @return the number of disk writes */
   int GetNumWrites() const;
 
+  /** @return the number of syncs of the database and log files, which are the only waits for the disk itself */
+  int GetNumSyncs() const;
+
   /**
    * Sets the future which is used to check for non-blocking flushes.
    * @param f the non-blocking flush check
@@ -101,18 +284,76 @@ class DiskManager {
   inline bool HasFlushLogFuture() { return flush_log_f_ != nullptr; }
 
  private:
-  int GetFileSize(const std::string &file_name);
+  int64_t GetFileSize(const std::string &file_name);
+  void LoadBitmap(bool db_file_existed);
+  void MarkPages(page_id_t first_page_id, size_t num_pages, bool allocated);
+  page_id_t FindFreePage(page_id_t near);
+  page_id_t FindFreeRun(size_t num_pages);
+  void Preallocate();
+  void LoadChecksums(bool db_file_existed);
+  bool RecordChecksums(const std::vector<PageWrite> &pages);
+  void CompleteChecksums(page_id_t first_page_id, size_t num_pages);
+  bool WriteChecksums(const std::set<page_id_t> &page_ids);
+  bool ChecksumMatches(page_id_t page_id, const char *page_data);
+  bool VerifyChecksum(page_id_t page_id, char *page_data);
+  void MapFile();
+  AsyncIO *GetAsyncIO();
+  std::future<bool> SubmitAsync(bool is_write, page_id_t page_id, char *page_data);
   // stream to write log file
   std::fstream log_io_;
   std::string log_name_;
-  // stream to write db file
-  std::fstream db_io_;
+  // descriptor of the log file to sync it with, -1 once closed
+  int log_fd_{-1};
+  // descriptor of the db file, -1 once closed
+  int db_fd_{-1};
   std::string file_name_;
-  std::atomic<page_id_t> next_page_id_;
+  // allocation bitmap, of bitmap pages of PAGE_SIZE bytes each, with a bit set for every allocated page id
+  std::string bitmap_name_;
+  int bitmap_fd_{-1};
+  std::vector<uint64_t> bitmap_;
+  // all page ids from next_page_id_ on are unallocated, those below it that are not are free pages to reuse
+  page_id_t next_page_id_;
+  size_t num_free_pages_{0};
+  page_id_t last_allocated_page_id_{INVALID_PAGE_ID};
+  // the file space of the pages below num_preallocated_pages_ is reserved, until preallocation turns out unsupported
+  page_id_t num_preallocated_pages_{0};
+  bool preallocation_supported_{true};
+  // protects the allocation bitmap and the five above
+  std::mutex allocation_latch_;
+  // checksums of every page before and after the write in flight, the same once it completed, 0 for pages written
+  // without one, as in the checksum file
+  struct PageChecksums {
+    uint32_t previous_;
+    uint32_t current_;
+  };
+  std::string checksum_name_;
+  int checksum_fd_{-1};
+  std::vector<PageChecksums> checksums_;
+  // pages whose write completed since the last sync, whose file entry still holds the previous checksum
+  std::set<page_id_t> completed_checksums_;
+  std::atomic<ChecksumPolicy> checksum_policy_{ChecksumPolicy::LOG};
+  PageRepairHandler repair_handler_;
+  std::atomic<int> num_checksum_failures_{0};
+  // protects the checksums and the repair handler
+  std::mutex checksum_latch_;
   int num_flushes_;
-  int num_writes_;
+  std::atomic<int> num_writes_;
+  std::atomic<int> num_syncs_{0};
   bool flush_log_;
   std::future<void> *flush_log_f_;
+  PageIOMode page_io_mode_;
+  // mapping of the read-only db file, nullptr if not mapped
+  char *mapping_{nullptr};
+  size_t mapping_size_{0};
+  // number of sequential accesses in progress on the mapping
+  int num_sequential_accesses_{0};
+  std::mutex mapping_latch_;
+  // asynchronous page I/O, set up on first use
+  AsyncIOBackend async_io_backend_;
+  std::unique_ptr<AsyncIO> async_io_;
+  std::once_flag async_io_init_;
+  // held shared while submitting asynchronous I/O, exclusively while shutting it down
+  std::shared_mutex async_io_latch_;
 };
 
 }  // namespace bustub
@@ -0,0 +1,66 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// extent_allocator.h
+//
+// Identification: src/include/storage/disk/extent_allocator.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <mutex>  // NOLINT
+
+#include "common/config.h"
+#include "common/macros.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+/**
+ * ExtentAllocator hands out the pages of a table or an index from extents of consecutive pages it reserves on disk,
+ * instead of taking every page from the end of the file. Tables growing at the same time then no longer interleave
+ * their pages, and a scan of a table reads runs of consecutive pages.
+ *
+ * The pages of the current extent not handed out yet are deallocated when the allocator is destroyed. Only a crash
+ * leaves them allocated.
+ */
+class ExtentAllocator {
+ public:
+  /**
+   * Creates a new ExtentAllocator.
+   * @param disk_manager the disk manager to reserve extents from, which must outlive the allocator
+   * @param extent_size the number of pages of an extent
+   */
+  explicit ExtentAllocator(DiskManager *disk_manager, size_t extent_size = EXTENT_SIZE)
+      : disk_manager_(disk_manager), extent_size_(extent_size) {
+    BUSTUB_ASSERT(extent_size > 0, "An extent needs at least one page.");
+  }
+
+  DISALLOW_COPY_AND_MOVE(ExtentAllocator);
+
+  ~ExtentAllocator();
+
+  /**
+   * Allocate a page, the next one of the current extent, or the first one of a new extent.
+   * @return the id of the allocated page, INVALID_PAGE_ID if no extent can be reserved
+   */
+  page_id_t AllocatePage();
+
+  /** @return the number of pages of an extent */
+  size_t GetExtentSize() const { return extent_size_; }
+
+ private:
+  DiskManager *disk_manager_;
+  size_t extent_size_;
+  /** The pages of the current extent from next_page_id_ up to end_page_id_ are not handed out yet. */
+  page_id_t next_page_id_{INVALID_PAGE_ID};
+  page_id_t end_page_id_{INVALID_PAGE_ID};
+  /** Protects the current extent. */
+  std::mutex latch_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,240 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_guard.h
+//
+// Identification: src/include/storage/page/page_guard.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <type_traits>
+
+#include "storage/page/page.h"
+
+namespace bustub {
+
+class BufferPoolManager;
+class ReadPageGuard;
+class WritePageGuard;
+
+/**
+ * BasicPageGuard holds a pin on a page and unpins it when it is dropped or destroyed. The page is unpinned dirty only
+ * if its data was accessed through GetDataMut or AsMut. Guards are move-only, moving one transfers the pin. The pages
+ * of a read-only database file may point into a read-only mapping of the file, so they are never handed out mutable.
+ */
+class BasicPageGuard {
+ public:
+  BasicPageGuard() = default;
+
+  /**
+   * Creates a new BasicPageGuard.
+   * @param bpm the buffer pool manager the page is pinned in
+   * @param page the pinned page, nullptr for an empty guard
+   */
+  BasicPageGuard(BufferPoolManager *bpm, Page *page) : bpm_(bpm), page_(page) {}
+
+  BasicPageGuard(const BasicPageGuard &) = delete;
+  BasicPageGuard &operator=(const BasicPageGuard &) = delete;
+
+  /** Takes over the pin of another guard, leaving it empty. */
+  BasicPageGuard(BasicPageGuard &&that) noexcept;
+
+  /** Drops the pin held by this guard, then takes over the pin of another guard, leaving it empty. */
+  BasicPageGuard &operator=(BasicPageGuard &&that) noexcept;
+
+  ~BasicPageGuard() { Drop(); }
+
+  /** Unpins the page and empties the guard. Dropping an empty guard does nothing. */
+  void Drop();
+
+  /**
+   * Latches the page for reading and moves the pin into a ReadPageGuard, leaving this guard empty.
+   * @return the read guard, empty if this guard is empty
+   */
+  ReadPageGuard UpgradeRead();
+
+  /**
+   * Latches the page for writing and moves the pin into a WritePageGuard, leaving this guard empty. The pages of a
+   * read-only database file cannot be latched for writing, their pin is released instead.
+   * @return the write guard, empty if this guard is empty or the database file is read-only
+   */
+  WritePageGuard UpgradeWrite();
+
+  /** @return false if the page could not be fetched or the guard was dropped or moved from, true otherwise */
+  bool IsValid() const { return page_ != nullptr; }
+
+  /** @return the id of the guarded page */
+  page_id_t PageId() const { return page_->GetPageId(); }
+
+  /** @return the data of the guarded page, read-only */
+  const char *GetData() const { return page_->GetData(); }
+
+  /** @return the data of the guarded page, which is unpinned dirty from now on, nullptr if the pool is read-only */
+  char *GetDataMut() {
+    if (IsReadOnly()) {
+      return nullptr;
+    }
+    is_dirty_ = true;
+    return page_->GetData();
+  }
+
+  /** @return the guarded page as a T, read-only. T is either a Page subclass or a layout of the page data. */
+  template <class T>
+  const T *As() const {
+    if constexpr (std::is_base_of_v<Page, T>) {
+      return static_cast<const T *>(page_);
+    } else {
+      return reinterpret_cast<const T *>(page_->GetData());
+    }
+  }
+
+  /** @return the guarded page as a T, which is unpinned dirty from now on, nullptr if the pool is read-only */
+  template <class T>
+  T *AsMut() {
+    if (IsReadOnly()) {
+      return nullptr;
+    }
+    is_dirty_ = true;
+    if constexpr (std::is_base_of_v<Page, T>) {
+      return static_cast<T *>(page_);
+    } else {
+      return reinterpret_cast<T *>(page_->GetData());
+    }
+  }
+
+  /**
+   * Sets whether the page is unpinned dirty, e.g. clean after a change through AsMut that turned out to change nothing.
+   * A page that is dirty already stays dirty until written back.
+   * @param is_dirty true to unpin the page dirty, false to unpin it clean
+   */
+  void SetDirty(bool is_dirty) { is_dirty_ = is_dirty; }
+
+ private:
+  friend class ReadPageGuard;
+  friend class WritePageGuard;
+
+  /** @return true if the page is pinned in a pool whose database file is read-only */
+  bool IsReadOnly() const;
+
+  BufferPoolManager *bpm_{nullptr};
+  Page *page_{nullptr};
+  bool is_dirty_{false};
+};
+
+/**
+ * ReadPageGuard holds a pin and the read latch on a page, and releases both when it is dropped or destroyed.
+ */
+class ReadPageGuard {
+ public:
+  ReadPageGuard() = default;
+
+  /**
+   * Creates a new ReadPageGuard.
+   * @param bpm the buffer pool manager the page is pinned in
+   * @param page the pinned and read-latched page, nullptr for an empty guard
+   */
+  ReadPageGuard(BufferPoolManager *bpm, Page *page) : guard_(bpm, page) {}
+
+  ReadPageGuard(const ReadPageGuard &) = delete;
+  ReadPageGuard &operator=(const ReadPageGuard &) = delete;
+  ReadPageGuard(ReadPageGuard &&that) noexcept = default;
+
+  /** Drops the latch and the pin held by this guard, then takes over those of another guard, leaving it empty. */
+  ReadPageGuard &operator=(ReadPageGuard &&that) noexcept;
+
+  ~ReadPageGuard() { Drop(); }
+
+  /** Unlatches and unpins the page and empties the guard. Dropping an empty guard does nothing. */
+  void Drop();
+
+  /** @return false if the page could not be fetched or the guard was dropped or moved from, true otherwise */
+  bool IsValid() const { return guard_.IsValid(); }
+
+  /** @return the id of the guarded page */
+  page_id_t PageId() const { return guard_.PageId(); }
+
+  /** @return the data of the guarded page */
+  const char *GetData() const { return guard_.GetData(); }
+
+  /** @return the guarded page as a T. T is either a Page subclass or a layout of the page data. */
+  template <class T>
+  const T *As() const {
+    return guard_.As<T>();
+  }
+
+ private:
+  friend class BasicPageGuard;
+
+  BasicPageGuard guard_;
+};
+
+/**
+ * WritePageGuard holds a pin and the write latch on a page, and releases both when it is dropped or destroyed. The page
+ * is unpinned dirty only if its data was accessed through GetDataMut or AsMut.
+ */
+class WritePageGuard {
+ public:
+  WritePageGuard() = default;
+
+  /**
+   * Creates a new WritePageGuard.
+   * @param bpm the buffer pool manager the page is pinned in
+   * @param page the pinned and write-latched page, nullptr for an empty guard
+   */
+  WritePageGuard(BufferPoolManager *bpm, Page *page) : guard_(bpm, page) {}
+
+  WritePageGuard(const WritePageGuard &) = delete;
+  WritePageGuard &operator=(const WritePageGuard &) = delete;
+  WritePageGuard(WritePageGuard &&that) noexcept = default;
+
+  /** Drops the latch and the pin held by this guard, then takes over those of another guard, leaving it empty. */
+  WritePageGuard &operator=(WritePageGuard &&that) noexcept;
+
+  ~WritePageGuard() { Drop(); }
+
+  /** Unlatches and unpins the page and empties the guard. Dropping an empty guard does nothing. */
+  void Drop();
+
+  /** @return false if the page could not be fetched or the guard was dropped or moved from, true otherwise */
+  bool IsValid() const { return guard_.IsValid(); }
+
+  /** @return the id of the guarded page */
+  page_id_t PageId() const { return guard_.PageId(); }
+
+  /** @return the data of the guarded page, read-only */
+  const char *GetData() const { return guard_.GetData(); }
+
+  /** @return the data of the guarded page, which is unpinned dirty from now on */
+  char *GetDataMut() { return guard_.GetDataMut(); }
+
+  /** @return the guarded page as a T, read-only. T is either a Page subclass or a layout of the page data. */
+  template <class T>
+  const T *As() const {
+    return guard_.As<T>();
+  }
+
+  /** @return the guarded page as a T, which is unpinned dirty from now on */
+  template <class T>
+  T *AsMut() {
+    return guard_.AsMut<T>();
+  }
+
+  /**
+   * Sets whether the page is unpinned dirty, e.g. clean after a change through AsMut that turned out to change nothing.
+   * A page that is dirty already stays dirty until written back.
+   * @param is_dirty true to unpin the page dirty, false to unpin it clean
+   */
+  void SetDirty(bool is_dirty) { guard_.SetDirty(is_dirty); }
+
+ private:
+  friend class BasicPageGuard;
+
+  BasicPageGuard guard_;
+};
+
+}  // namespace bustub
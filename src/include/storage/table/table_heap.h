@@ -12,6 +12,8 @@
 
 #pragma once
 
+#include <memory>
+
 #include "buffer/buffer_pool_manager.h"
 #include "recovery/log_manager.h"
 #include "storage/page/table_page.h"
@@ -22,7 +24,8 @@ namespace bustub {
 
 /**
  * TableHeap represents a physical table on disk.
- * This is just a doubly-linked list of pages.
+ * This is just a doubly-linked list of pages, created in extents of consecutive pages so that the list mostly runs
+ * through the file in order.
  */
 class TableHeap {
   friend class TableIterator;
@@ -46,18 +49,20 @@ class TableHeap {
    * @param lock_manager the lock manager
    * @param log_manager the log manager
    * @param txn the creating transaction
+   * @param extent_size the number of consecutive pages the table reserves at a time
    */
   TableHeap(BufferPoolManager *buffer_pool_manager, LockManager *lock_manager, LogManager *log_manager,
-            Transaction *txn);
+            Transaction *txn, size_t extent_size = EXTENT_SIZE);
 
   /**
    * Insert a tuple into the table. If the tuple is too large (>= page_size), return false.
    * @param tuple tuple to insert
    * @param[out] rid the rid of the inserted tuple
    * @param txn the transaction performing the insert
+   * @param strategy the ring of frames a bulk load reads and creates pages in, nullptr for the shared pool
    * @return true iff the insert is successful
    */
-  bool InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn);
+  bool InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn, BufferAccessStrategy *strategy = nullptr);
 
   /**
    * Mark the tuple as deleted. The actual delete will occur when ApplyDelete is called.
@@ -99,7 +104,7 @@ class TableHeap {
    */
   bool GetTuple(const RID &rid, Tuple *tuple, Transaction *txn);
 
-  /** @return the begin iterator of this table */
+  /** @return the begin iterator of this table, the scan recycles a private ring of SCAN_RING_SIZE frames */
   TableIterator Begin(Transaction *txn);
 
   /** @return the end iterator of this table */
@@ -113,6 +118,7 @@ class TableHeap {
   LockManager *lock_manager_;
   LogManager *log_manager_;
   page_id_t first_page_id_{};
+  std::unique_ptr<ExtentAllocator> extent_allocator_;
 };
 
 }  // namespace bustub
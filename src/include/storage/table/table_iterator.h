@@ -13,7 +13,10 @@
 #pragma once
 
 #include <cassert>
+#include <memory>
+#include <utility>
 
+#include "buffer/buffer_access_strategy.h"
 #include "common/rid.h"
 #include "concurrency/transaction.h"
 #include "storage/table/tuple.h"
@@ -21,6 +24,7 @@
 namespace bustub {
 
 class TableHeap;
+class TablePage;
 
 /**
  * TableIterator enables the sequential scan of a TableHeap.
@@ -29,10 +33,23 @@ class TableIterator {
   friend class Cursor;
 
  public:
-  TableIterator(TableHeap *table_heap, RID rid, Transaction *txn);
+  /**
+   * Creates a new TableIterator.
+   * @param table_heap the table to iterate over
+   * @param rid the rid of the current tuple
+   * @param txn the transaction performing the scan
+   * @param strategy the ring of frames the scan reads pages into, nullptr for the shared pool
+   */
+  TableIterator(TableHeap *table_heap, RID rid, Transaction *txn,
+                std::shared_ptr<BufferAccessStrategy> strategy = nullptr);
 
   TableIterator(const TableIterator &other)
-      : table_heap_(other.table_heap_), tuple_(new Tuple(*other.tuple_)), txn_(other.txn_) {}
+      : table_heap_(other.table_heap_),
+        tuple_(new Tuple(*other.tuple_)),
+        txn_(other.txn_),
+        strategy_(other.strategy_),
+        read_ahead_page_id_(other.read_ahead_page_id_),
+        pages_ahead_(other.pages_ahead_) {}
 
   ~TableIterator() { delete tuple_; }
 
@@ -52,13 +69,29 @@ class TableIterator {
     table_heap_ = other.table_heap_;
     *tuple_ = *other.tuple_;
     txn_ = other.txn_;
+    strategy_ = other.strategy_;
+    read_ahead_page_id_ = other.read_ahead_page_id_;
+    pages_ahead_ = other.pages_ahead_;
     return *this;
   }
 
  private:
+  /**
+   * Prefetch the pages following the current one until TABLE_READ_AHEAD_WINDOW of them are on their way. The next page
+   * id of a prefetched page is only known once it is loaded, so the window grows as the reads complete.
+   * @param cur_page the current page, pinned and latched
+   */
+  void ReadAhead(const TablePage *cur_page);
+
   TableHeap *table_heap_;
   Tuple *tuple_;
   Transaction *txn_;
+  /** Copies of an iterator share the ring of the scan. */
+  std::shared_ptr<BufferAccessStrategy> strategy_;
+  /** The last page prefetched ahead of the scan. */
+  page_id_t read_ahead_page_id_{INVALID_PAGE_ID};
+  /** Number of pages prefetched ahead of the current page. */
+  size_t pages_ahead_{0};
 };
 
 }  // namespace bustub
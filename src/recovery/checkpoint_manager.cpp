@@ -18,6 +18,8 @@ void CheckpointManager::BeginCheckpoint() {
   // Block all the transactions and ensure that both the WAL and all dirty buffer pool pages are persisted to disk,
   // creating a consistent checkpoint. Do NOT allow transactions to resume at the end of this method, resume them
   // in CheckpointManager::EndCheckpoint() instead. This is for grading purposes.
+  // Written pages and log are persisted only once synced: see DiskManager::SyncLog, and
+  // BufferPoolSet::FlushAllPages, which flushes the pages of every pool, each pool ending with DiskManager::Sync.
 }
 
 void CheckpointManager::EndCheckpoint() {
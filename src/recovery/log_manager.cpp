@@ -19,6 +19,8 @@ namespace bustub {
  * The flush can be triggered when timeout or the log buffer is full or buffer
  * pool manager wants to force flush (it only happens when the flushed page has
  * a larger LSN than persistent LSN)
+ * A flush writes the log buffer with DiskManager::WriteLog, then makes it
+ * durable with DiskManager::SyncLog before advancing the persistent LSN
  *
  * This thread runs forever until system shutdown/StopFlushThread
  */
@@ -0,0 +1,318 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// async_io.cpp
+//
+// Identification: src/storage/disk/async_io.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/async_io.h"
+
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <vector>
+
+#include "common/logger.h"
+
+namespace bustub {
+
+// Page offsets reach PAGE_SIZE times the largest page id, far beyond 4 GB.
+static_assert(sizeof(off_t) >= sizeof(int64_t), "positional I/O needs 64-bit file offsets");
+
+bool ReadPageAt(int fd, page_id_t page_id, char *page_data) {
+  off_t offset = static_cast<off_t>(page_id) * PAGE_SIZE;
+  size_t read_count = 0;
+  while (read_count < PAGE_SIZE) {
+    ssize_t rc = pread(fd, page_data + read_count, PAGE_SIZE - read_count, offset + read_count);
+    if (rc < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return false;
+    }
+    if (rc == 0) {
+      break;
+    }
+    read_count += rc;
+  }
+  // if file ends before reading PAGE_SIZE
+  if (read_count < PAGE_SIZE) {
+    memset(page_data + read_count, 0, PAGE_SIZE - read_count);
+  }
+  return true;
+}
+
+bool WritePageAt(int fd, page_id_t page_id, const char *page_data) {
+  off_t offset = static_cast<off_t>(page_id) * PAGE_SIZE;
+  size_t written = 0;
+  while (written < PAGE_SIZE) {
+    ssize_t rc = pwrite(fd, page_data + written, PAGE_SIZE - written, offset + written);
+    if (rc < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return false;
+    }
+    written += rc;
+  }
+  return true;
+}
+
+bool WritePagesAt(int fd, page_id_t first_page_id, const char *const *pages, size_t num_pages) {
+  std::vector<iovec> iov(num_pages);
+  for (size_t i = 0; i < num_pages; ++i) {
+    iov[i].iov_base = const_cast<char *>(pages[i]);
+    iov[i].iov_len = PAGE_SIZE;
+  }
+  off_t offset = static_cast<off_t>(first_page_id) * PAGE_SIZE;
+  size_t index = 0;
+  while (index < num_pages) {
+    int count = static_cast<int>(std::min<size_t>(num_pages - index, IOV_MAX));
+    ssize_t rc = pwritev(fd, &iov[index], count, offset);
+    if (rc < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return false;
+    }
+    offset += rc;
+    // skip what was written, a short write may end in the middle of a page
+    for (auto written = static_cast<size_t>(rc); written > 0;) {
+      size_t n = std::min(written, iov[index].iov_len);
+      iov[index].iov_base = static_cast<char *>(iov[index].iov_base) + n;
+      iov[index].iov_len -= n;
+      written -= n;
+      if (iov[index].iov_len == 0) {
+        index++;
+      }
+    }
+  }
+  return true;
+}
+
+void AsyncIO::Complete(std::unique_ptr<AsyncIORequest> request) {
+  bool succeeded = request->is_write_ ? WritePageAt(fd_, request->page_id_, request->data_)
+                                      : ReadPageAt(fd_, request->page_id_, request->data_);
+  if (!succeeded) {
+    LOG_DEBUG("I/O error during asynchronous page I/O");
+  }
+  Finish(std::move(request), succeeded);
+}
+
+void AsyncIO::Finish(std::unique_ptr<AsyncIORequest> request, bool succeeded) {
+  if (succeeded && !request->is_write_ && on_read_) {
+    succeeded = on_read_(request->page_id_, request->data_);
+  }
+  if (succeeded && request->is_write_ && on_write_) {
+    on_write_(request->page_id_, request->data_);
+  }
+  request->done_.set_value(succeeded);
+}
+
+std::unique_ptr<IoUringAsyncIO> IoUringAsyncIO::Create(int fd, ReadCompletionHandler on_read,
+                                                       WriteCompletionHandler on_write) {
+#if defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter)
+  std::unique_ptr<IoUringAsyncIO> async_io(new IoUringAsyncIO(fd, std::move(on_read), std::move(on_write)));
+  io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  async_io->ring_fd_ = static_cast<int>(syscall(__NR_io_uring_setup, ASYNC_IO_QUEUE_DEPTH, &params));
+  if (async_io->ring_fd_ < 0) {
+    return nullptr;
+  }
+
+  // Map the rings as the kernel describes them.
+  async_io->sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  async_io->cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+  async_io->sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+  bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+  if (single_mmap) {
+    async_io->sq_ring_size_ = std::max(async_io->sq_ring_size_, async_io->cq_ring_size_);
+  }
+  async_io->sq_ring_ = mmap(nullptr, async_io->sq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                            async_io->ring_fd_, IORING_OFF_SQ_RING);
+  if (async_io->sq_ring_ == MAP_FAILED) {
+    async_io->sq_ring_ = nullptr;
+    return nullptr;
+  }
+  if (single_mmap) {
+    async_io->cq_ring_ = async_io->sq_ring_;
+  } else {
+    async_io->cq_ring_ = mmap(nullptr, async_io->cq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                              async_io->ring_fd_, IORING_OFF_CQ_RING);
+    if (async_io->cq_ring_ == MAP_FAILED) {
+      async_io->cq_ring_ = nullptr;
+      return nullptr;
+    }
+  }
+  async_io->sqes_ = mmap(nullptr, async_io->sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                         async_io->ring_fd_, IORING_OFF_SQES);
+  if (async_io->sqes_ == MAP_FAILED) {
+    async_io->sqes_ = nullptr;
+    return nullptr;
+  }
+
+  auto *sq = static_cast<char *>(async_io->sq_ring_);
+  auto *cq = static_cast<char *>(async_io->cq_ring_);
+  async_io->sq_tail_ = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+  async_io->sq_mask_ = reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+  async_io->sq_array_ = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+  async_io->cq_head_ = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+  async_io->cq_tail_ = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+  async_io->cq_mask_ = reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+  async_io->cqes_ = cq + params.cq_off.cqes;
+
+  IoUringAsyncIO *raw = async_io.get();
+  async_io->completion_thread_ = std::make_unique<std::thread>([raw] { raw->ReapCompletions(); });
+  return async_io;
+#else
+  return nullptr;
+#endif
+}
+
+IoUringAsyncIO::~IoUringAsyncIO() {
+  if (completion_thread_ != nullptr) {
+    {
+      std::scoped_lock lock(latch_);
+      stopping_ = true;
+      // A no-op without a request wakes the completion thread up, which exits once every request has completed.
+      SubmitEntry(IORING_OP_NOP, nullptr);
+    }
+    completion_thread_->join();
+  }
+  if (sqes_ != nullptr) {
+    munmap(sqes_, sqes_size_);
+  }
+  if (cq_ring_ != nullptr && cq_ring_ != sq_ring_) {
+    munmap(cq_ring_, cq_ring_size_);
+  }
+  if (sq_ring_ != nullptr) {
+    munmap(sq_ring_, sq_ring_size_);
+  }
+  if (ring_fd_ >= 0) {
+    close(ring_fd_);
+  }
+}
+
+void IoUringAsyncIO::Submit(std::unique_ptr<AsyncIORequest> request) {
+  std::unique_lock lock(latch_);
+  // The completion ring holds twice as many entries as the submission ring, so it can never overflow.
+  completed_.wait(lock, [this] { return num_in_flight_ < ASYNC_IO_QUEUE_DEPTH; });
+  num_in_flight_++;
+  uint8_t opcode = request->is_write_ ? IORING_OP_WRITE : IORING_OP_READ;
+  SubmitEntry(opcode, request.release());
+}
+
+void IoUringAsyncIO::SubmitEntry(uint8_t opcode, AsyncIORequest *request) {
+  unsigned tail = *sq_tail_;
+  unsigned index = tail & *sq_mask_;
+  io_uring_sqe &sqe = static_cast<io_uring_sqe *>(sqes_)[index];
+  memset(&sqe, 0, sizeof(sqe));
+  sqe.opcode = opcode;
+  sqe.fd = fd_;
+  if (request != nullptr) {
+    sqe.off = static_cast<uint64_t>(request->page_id_) * PAGE_SIZE;
+    sqe.addr = reinterpret_cast<uint64_t>(request->data_);
+    sqe.len = PAGE_SIZE;
+  }
+  sqe.user_data = reinterpret_cast<uint64_t>(request);
+  sq_array_[index] = index;
+  // The kernel reads the entry once it sees the new tail.
+  __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+  while (syscall(__NR_io_uring_enter, ring_fd_, 1, 0, 0, nullptr, 0) < 0 && errno == EINTR) {
+  }
+}
+
+void IoUringAsyncIO::ReapCompletions() {
+  while (true) {
+    unsigned head = *cq_head_;
+    if (head == __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE)) {
+      {
+        std::scoped_lock lock(latch_);
+        if (stopping_ && num_in_flight_ == 0) {
+          return;
+        }
+      }
+      syscall(__NR_io_uring_enter, ring_fd_, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+      continue;
+    }
+
+    const io_uring_cqe &cqe = static_cast<io_uring_cqe *>(cqes_)[head & *cq_mask_];
+    std::unique_ptr<AsyncIORequest> request(reinterpret_cast<AsyncIORequest *>(cqe.user_data));
+    int res = cqe.res;
+    // The kernel may reuse the entry once it sees the new head.
+    __atomic_store_n(cq_head_, head + 1, __ATOMIC_RELEASE);
+    if (request == nullptr) {
+      continue;
+    }
+
+    {
+      // Taking the latch also orders the completion after the submission for the thread sanitizer, which cannot see
+      // the ordering the rings provide.
+      std::scoped_lock lock(latch_);
+      num_in_flight_--;
+    }
+    completed_.notify_all();
+    if (res == PAGE_SIZE) {
+      Finish(std::move(request), true);
+    } else {
+      // A short transfer, a read past the end of the file or an error: redo the request synchronously, which
+      // zero-fills what lies past the end of the file and reports errors as the synchronous I/O does.
+      Complete(std::move(request));
+    }
+  }
+}
+
+ThreadPoolAsyncIO::ThreadPoolAsyncIO(int fd, size_t num_threads, ReadCompletionHandler on_read,
+                                     WriteCompletionHandler on_write)
+    : AsyncIO(fd, std::move(on_read), std::move(on_write)) {
+  for (size_t i = 0; i < num_threads; ++i) {
+    threads_.emplace_back([this] {
+      std::unique_lock lock(latch_);
+      while (true) {
+        queued_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+        if (queue_.empty()) {
+          return;
+        }
+        std::unique_ptr<AsyncIORequest> request = std::move(queue_.front());
+        queue_.pop_front();
+        dequeued_.notify_one();
+        lock.unlock();
+        Complete(std::move(request));
+        lock.lock();
+      }
+    });
+  }
+}
+
+ThreadPoolAsyncIO::~ThreadPoolAsyncIO() {
+  {
+    std::scoped_lock lock(latch_);
+    stopping_ = true;
+  }
+  queued_.notify_all();
+  for (auto &thread : threads_) {
+    thread.join();
+  }
+}
+
+void ThreadPoolAsyncIO::Submit(std::unique_ptr<AsyncIORequest> request) {
+  {
+    std::unique_lock lock(latch_);
+    dequeued_.wait(lock, [this] { return queue_.size() < ASYNC_IO_QUEUE_DEPTH; });
+    queue_.push_back(std::move(request));
+  }
+  queued_.notify_one();
+}
+
+}  // namespace bustub
@@ -10,27 +10,64 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <fcntl.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
 #include <cassert>
+#include <cerrno>
+#include <cstdint>
 #include <cstring>
 #include <iostream>
+#include <set>
 #include <string>
 #include <thread>  // NOLINT
 
 #include "common/exception.h"
 #include "common/logger.h"
+#include "common/macros.h"
+#include "common/util/crc32c_util.h"
 #include "storage/disk/disk_manager.h"
 
 namespace bustub {
 
 static char *buffer_used;
 
+/** Number of pages an allocation bitmap page keeps track of, and number of 64-bit words it holds. */
+static constexpr size_t BITMAP_PAGE_BITS = PAGE_SIZE * 8;
+static constexpr size_t BITMAP_PAGE_WORDS = PAGE_SIZE / sizeof(uint64_t);
+
+/** @return true if a buffer can take part in direct I/O as is */
+static bool IsPageAligned(const char *page_data) { return reinterpret_cast<uintptr_t>(page_data) % PAGE_SIZE == 0; }
+
+/** Reads or writes a page through an aligned copy of the buffer, for direct I/O. */
+static bool PageIOThroughAlignedCopy(int fd, bool is_write, page_id_t page_id, char *page_data) {
+  alignas(PAGE_SIZE) char aligned_data[PAGE_SIZE];
+  if (is_write) {
+    memcpy(aligned_data, page_data, PAGE_SIZE);
+    return WritePageAt(fd, page_id, aligned_data);
+  }
+  if (!ReadPageAt(fd, page_id, aligned_data)) {
+    return false;
+  }
+  memcpy(page_data, aligned_data, PAGE_SIZE);
+  return true;
+}
+
 /**
  * Constructor: open/create a single database file & log file
  * @input db_file: database file name
  */
-DiskManager::DiskManager(const std::string &db_file)
-    : file_name_(db_file), next_page_id_(0), num_flushes_(0), num_writes_(0), flush_log_(false), flush_log_f_(nullptr) {
+DiskManager::DiskManager(const std::string &db_file, PageIOMode page_io_mode, AsyncIOBackend async_io_backend)
+    : file_name_(db_file),
+      next_page_id_(0),
+      num_flushes_(0),
+      num_writes_(0),
+      flush_log_(false),
+      flush_log_f_(nullptr),
+      page_io_mode_(page_io_mode),
+      async_io_backend_(async_io_backend) {
   std::string::size_type n = file_name_.rfind('.');
   if (n == std::string::npos) {
     LOG_DEBUG("wrong file format");
@@ -51,28 +88,98 @@ DiskManager::DiskManager(const std::string &db_file)
       throw Exception("can't open dblog file");
     }
   }
+  // the stream has no descriptor to sync the log with, fdatasync through another one of the same file
+  log_fd_ = open(log_name_.c_str(), O_WRONLY);
 
-  db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
-  // directory or file does not exist
-  if (!db_io_.is_open()) {
-    db_io_.clear();
-    // create a new file
-    db_io_.open(db_file, std::ios::binary | std::ios::trunc | std::ios::out);
-    db_io_.close();
-    // reopen with original mode
-    db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
-    if (!db_io_.is_open()) {
-      throw Exception("can't open db file");
+  // open the db file, creating it if it does not exist and is not to be read-only
+  bool db_file_existed = access(db_file.c_str(), F_OK) == 0;
+  if (IsReadOnly()) {
+    db_fd_ = open(db_file.c_str(), O_RDONLY);
+  }
+  if (page_io_mode_ == PageIOMode::DIRECT) {
+    db_fd_ = open(db_file.c_str(), O_RDWR | O_CREAT | O_DIRECT, 0644);
+    if (db_fd_ < 0 && errno == EINVAL) {
+      LOG_DEBUG("O_DIRECT not supported, falling back to buffered I/O");
+      page_io_mode_ = PageIOMode::BUFFERED;
     }
   }
+  if (page_io_mode_ == PageIOMode::BUFFERED) {
+    db_fd_ = open(db_file.c_str(), O_RDWR | O_CREAT, 0644);
+  }
+  if (db_fd_ < 0) {
+    throw Exception("can't open db file");
+  }
+  bitmap_name_ = file_name_.substr(0, n) + ".bitmap";
+  // a read-only db file allocates nothing, and needs no allocation bitmap
+  if (!IsReadOnly()) {
+    LoadBitmap(db_file_existed);
+  }
+  checksum_name_ = file_name_.substr(0, n) + ".checksum";
+  LoadChecksums(db_file_existed);
+  if (IsReadOnly()) {
+    MapFile();
+  }
   buffer_used = nullptr;
 }
 
+DiskManager::~DiskManager() {
+  async_io_.reset();
+  // the buffer pool may still point into the mapping until it is gone, so it outlives ShutDown
+  if (mapping_ != nullptr) {
+    munmap(mapping_, mapping_size_);
+  }
+  if (db_fd_ >= 0) {
+    close(db_fd_);
+  }
+  if (log_fd_ >= 0) {
+    close(log_fd_);
+  }
+  if (bitmap_fd_ >= 0) {
+    close(bitmap_fd_);
+  }
+  if (checksum_fd_ >= 0) {
+    close(checksum_fd_);
+  }
+}
+
 /**
  * Close all file streams
  */
 void DiskManager::ShutDown() {
-  db_io_.close();
+  bool synced = false;
+  {
+    // wait for the asynchronous I/O in flight, later requests are dropped
+    std::unique_lock lock(async_io_latch_);
+    async_io_.reset();
+    if (db_fd_ >= 0) {
+      synced = !IsReadOnly() && fdatasync(db_fd_) == 0;
+      close(db_fd_);
+      db_fd_ = -1;
+    }
+  }
+  if (log_fd_ >= 0) {
+    close(log_fd_);
+    log_fd_ = -1;
+  }
+  {
+    std::scoped_lock lock(allocation_latch_);
+    if (bitmap_fd_ >= 0) {
+      close(bitmap_fd_);
+      bitmap_fd_ = -1;
+    }
+  }
+  {
+    std::scoped_lock lock(checksum_latch_);
+    if (checksum_fd_ >= 0) {
+      // the previous checksums of the pages written are only dropped once the pages are durable
+      if (!IsReadOnly() && (!synced || !WriteChecksums(completed_checksums_) || fdatasync(checksum_fd_) != 0)) {
+        LOG_DEBUG("I/O error while syncing, the previous checksums of the pages written are kept");
+      }
+      completed_checksums_.clear();
+      close(checksum_fd_);
+      checksum_fd_ = -1;
+    }
+  }
   log_io_.close();
 }
 
@@ -80,51 +187,190 @@ void DiskManager::ShutDown() {
  * Write the contents of the specified page into disk file
  */
 void DiskManager::WritePage(page_id_t page_id, const char *page_data) {
-  size_t offset = static_cast<size_t>(page_id) * PAGE_SIZE;
-  // set write cursor to offset
+  if (IsReadOnly()) {
+    LOG_DEBUG("writing to a read-only db file");
+    return;
+  }
   num_writes_ += 1;
-  db_io_.seekp(offset);
-  db_io_.write(page_data, PAGE_SIZE);
-  // check for I/O error
-  if (db_io_.bad()) {
+  if (!RecordChecksums({{page_id, page_data}})) {
+    LOG_DEBUG("I/O error while writing the checksum");
+    return;
+  }
+  // positional write, without a file position shared with the other threads
+  bool written = page_io_mode_ == PageIOMode::DIRECT && !IsPageAligned(page_data)
+                     ? PageIOThroughAlignedCopy(db_fd_, true, page_id, const_cast<char *>(page_data))
+                     : WritePageAt(db_fd_, page_id, page_data);
+  if (!written) {
     LOG_DEBUG("I/O error while writing");
     return;
   }
-  // needs to flush to keep disk file in sync
-  db_io_.flush();
+  CompleteChecksums(page_id, 1);
 }
 
 /**
- * Read the contents of the specified page into the given memory area
+ * Write the contents of several pages into disk file, coalescing consecutive pages
  */
-void DiskManager::ReadPage(page_id_t page_id, char *page_data) {
-  int offset = page_id * PAGE_SIZE;
-  // check if read beyond file length
-  if (offset > GetFileSize(file_name_)) {
-    LOG_DEBUG("I/O error reading past end of file");
-    // std::cerr << "I/O error while reading" << std::endl;
-  } else {
-    // set read cursor to offset
-    db_io_.seekp(offset);
-    db_io_.read(page_data, PAGE_SIZE);
-    if (db_io_.bad()) {
-      LOG_DEBUG("I/O error while reading");
+void DiskManager::WritePages(std::vector<PageWrite> pages) {
+  if (IsReadOnly()) {
+    LOG_DEBUG("writing to a read-only db file");
+    return;
+  }
+  std::stable_sort(pages.begin(), pages.end(),
+                   [](const PageWrite &a, const PageWrite &b) { return a.page_id_ < b.page_id_; });
+  // the last write of a page wins
+  auto last = std::unique(pages.rbegin(), pages.rend(),
+                          [](const PageWrite &a, const PageWrite &b) { return a.page_id_ == b.page_id_; });
+  pages.erase(pages.begin(), last.base());
+  // the checksums of all the pages are made durable at once, before any of them is written
+  if (!RecordChecksums(pages)) {
+    LOG_DEBUG("I/O error while writing the checksums");
+    return;
+  }
+  std::vector<const char *> run;
+  page_id_t run_start = INVALID_PAGE_ID;
+  auto write_run = [this, &run, &run_start] {
+    if (run.empty()) {
       return;
     }
-    // if file ends before reading PAGE_SIZE
-    int read_count = db_io_.gcount();
-    if (read_count < PAGE_SIZE) {
-      LOG_DEBUG("Read less than a page");
-      db_io_.clear();
-      // std::cerr << "Read less than a page" << std::endl;
-      memset(page_data + read_count, 0, PAGE_SIZE - read_count);
+    num_writes_ += run.size();
+    if (!WritePagesAt(db_fd_, run_start, run.data(), run.size())) {
+      LOG_DEBUG("I/O error while writing");
+    } else {
+      CompleteChecksums(run_start, run.size());
+    }
+    run.clear();
+  };
+  for (const PageWrite &page : pages) {
+    // direct I/O takes aligned buffers only, the others are written on their own through an aligned copy
+    if (page_io_mode_ == PageIOMode::DIRECT && !IsPageAligned(page.data_)) {
+      write_run();
+      num_writes_ += 1;
+      if (!PageIOThroughAlignedCopy(db_fd_, true, page.page_id_, const_cast<char *>(page.data_))) {
+        LOG_DEBUG("I/O error while writing");
+      } else {
+        CompleteChecksums(page.page_id_, 1);
+      }
+      continue;
+    }
+    if (!run.empty() && page.page_id_ != run_start + static_cast<page_id_t>(run.size())) {
+      write_run();
+    }
+    if (run.empty()) {
+      run_start = page.page_id_;
+    }
+    run.push_back(page.data_);
+  }
+  write_run();
+}
+
+/**
+ * Read the contents of the specified page into the given memory area
+ */
+bool DiskManager::ReadPage(page_id_t page_id, char *page_data) {
+  // positional read, without a file position shared with the other threads, zero-filled past the end of the file
+  bool read = page_io_mode_ == PageIOMode::DIRECT && !IsPageAligned(page_data)
+                  ? PageIOThroughAlignedCopy(db_fd_, false, page_id, page_data)
+                  : ReadPageAt(db_fd_, page_id, page_data);
+  if (!read) {
+    LOG_DEBUG("I/O error while reading");
+    return false;
+  }
+  return VerifyChecksum(page_id, page_data);
+}
+
+/**
+ * Start writing the contents of the specified page into disk file
+ */
+std::future<bool> DiskManager::WritePageAsync(page_id_t page_id, const char *page_data) {
+  if (IsReadOnly()) {
+    LOG_DEBUG("writing to a read-only db file");
+    std::promise<bool> done;
+    done.set_value(false);
+    return done.get_future();
+  }
+  num_writes_ += 1;
+  return SubmitAsync(true, page_id, const_cast<char *>(page_data));
+}
+
+/**
+ * Start reading the contents of the specified page into the given memory area
+ */
+std::future<bool> DiskManager::ReadPageAsync(page_id_t page_id, char *page_data) {
+  return SubmitAsync(false, page_id, page_data);
+}
+
+/**
+ * Returns the backend performing the asynchronous I/O, setting it up on first use
+ */
+AsyncIOBackend DiskManager::GetAsyncIOBackend() {
+  std::shared_lock lock(async_io_latch_);
+  GetAsyncIO();
+  return async_io_backend_;
+}
+
+/**
+ * Private helper function to set up the asynchronous I/O backend on first use, nullptr once shut down. The caller
+ * must hold async_io_latch_
+ */
+AsyncIO *DiskManager::GetAsyncIO() {
+  if (db_fd_ < 0) {
+    return nullptr;
+  }
+  std::call_once(async_io_init_, [this] {
+    auto verify_checksum = [this](page_id_t page_id, char *page_data) { return VerifyChecksum(page_id, page_data); };
+    auto complete_checksum = [this](page_id_t page_id, const char * /*page_data*/) { CompleteChecksums(page_id, 1); };
+    if (async_io_backend_ == AsyncIOBackend::IO_URING) {
+      async_io_ = IoUringAsyncIO::Create(db_fd_, verify_checksum, complete_checksum);
+    }
+    if (async_io_ == nullptr) {
+      async_io_backend_ = AsyncIOBackend::THREAD_POOL;
+      async_io_ = std::make_unique<ThreadPoolAsyncIO>(db_fd_, ASYNC_IO_THREADS, verify_checksum, complete_checksum);
     }
+  });
+  return async_io_.get();
+}
+
+/**
+ * Private helper function to submit an asynchronous page read or write
+ */
+std::future<bool> DiskManager::SubmitAsync(bool is_write, page_id_t page_id, char *page_data) {
+  auto request = std::make_unique<AsyncIORequest>();
+  request->is_write_ = is_write;
+  request->page_id_ = page_id;
+  request->data_ = page_data;
+  std::future<bool> done = request->done_.get_future();
+  std::shared_lock lock(async_io_latch_);
+  AsyncIO *async_io = GetAsyncIO();
+  if (async_io == nullptr) {
+    LOG_DEBUG("asynchronous page I/O after shutdown");
+    request->done_.set_value(false);
+    return done;
   }
+  if (is_write && !RecordChecksums({{page_id, page_data}})) {
+    LOG_DEBUG("I/O error while writing the checksum");
+    request->done_.set_value(false);
+    return done;
+  }
+  if (page_io_mode_ == PageIOMode::DIRECT && !IsPageAligned(page_data)) {
+    // the aligned copy would have to outlive the call, perform the request synchronously instead
+    bool succeeded = PageIOThroughAlignedCopy(db_fd_, is_write, page_id, page_data);
+    if (!succeeded) {
+      LOG_DEBUG("I/O error during asynchronous page I/O");
+    } else if (is_write) {
+      CompleteChecksums(page_id, 1);
+    } else {
+      succeeded = VerifyChecksum(page_id, page_data);
+    }
+    request->done_.set_value(succeeded);
+    return done;
+  }
+  async_io->Submit(std::move(request));
+  return done;
 }
 
 /**
  * Write the contents of the log into disk file
- * Only return when sync is done, and only perform sequence write
+ * Only perform sequence write, SyncLog makes the log durable
  */
 void DiskManager::WriteLog(char *log_data, int size) {
   // enforce swap log buffer
@@ -146,22 +392,71 @@ void DiskManager::WriteLog(char *log_data, int size) {
   // sequence write
   log_io_.write(log_data, size);
 
+  // hand the log over to the kernel, SyncLog makes it durable
+  log_io_.flush();
+
   // check for I/O error
   if (log_io_.bad()) {
     LOG_DEBUG("I/O error while writing log");
     return;
   }
-  // needs to flush to keep disk file in sync
-  log_io_.flush();
   flush_log_ = false;
 }
 
+/**
+ * Make the page writes completed so far durable
+ */
+void DiskManager::Sync() {
+  std::shared_lock lock(async_io_latch_);
+  if (db_fd_ < 0) {
+    return;
+  }
+  num_syncs_ += 1;
+  // the allocation bitmap goes along with the pages
+  {
+    std::scoped_lock allocation_lock(allocation_latch_);
+    if (bitmap_fd_ >= 0 && fdatasync(bitmap_fd_) != 0) {
+      LOG_DEBUG("I/O error while syncing the allocation bitmap");
+    }
+  }
+  // the checksums are synced before their pages are written, only the previous ones of the pages whose write has
+  // completed so far are left to drop once these are durable
+  std::set<page_id_t> completed;
+  {
+    std::scoped_lock checksum_lock(checksum_latch_);
+    completed.swap(completed_checksums_);
+  }
+  if (fdatasync(db_fd_) != 0) {
+    LOG_DEBUG("I/O error while syncing");
+    std::scoped_lock checksum_lock(checksum_latch_);
+    completed_checksums_.merge(completed);
+    return;
+  }
+  std::scoped_lock checksum_lock(checksum_latch_);
+  if (!completed.empty() && checksum_fd_ >= 0 && (!WriteChecksums(completed) || fdatasync(checksum_fd_) != 0)) {
+    LOG_DEBUG("I/O error while syncing the checksums");
+  }
+}
+
+/**
+ * Make the log written so far durable
+ */
+void DiskManager::SyncLog() {
+  if (log_fd_ < 0) {
+    return;
+  }
+  num_syncs_ += 1;
+  if (fdatasync(log_fd_) != 0) {
+    LOG_DEBUG("I/O error while syncing log");
+  }
+}
+
 /**
  * Read the contents of the log into the given memory area
  * Always read from the beginning and perform sequence read
  * @return: false means already reach the end
  */
-bool DiskManager::ReadLog(char *log_data, int size, int offset) {
+bool DiskManager::ReadLog(char *log_data, int size, int64_t offset) {
   if (offset >= GetFileSize(log_name_)) {
     // LOG_DEBUG("end of log file");
     // LOG_DEBUG("file size is %d", GetFileSize(log_name_));
@@ -188,14 +483,72 @@ bool DiskManager::ReadLog(char *log_data, int size, int offset) {
  * Allocate new page (operations like create index/table)
  * For now just keep an increasing counter
  */
-page_id_t DiskManager::AllocatePage() { return next_page_id_++; }
+page_id_t DiskManager::AllocatePage(page_id_t near) {
+  if (IsReadOnly()) {
+    LOG_DEBUG("allocating a page in a read-only db file");
+    return INVALID_PAGE_ID;
+  }
+  std::scoped_lock lock(allocation_latch_);
+  page_id_t page_id = num_free_pages_ > 0 ? FindFreePage(near != INVALID_PAGE_ID ? near : last_allocated_page_id_)
+                                          : INVALID_PAGE_ID;
+  if (page_id == INVALID_PAGE_ID) {
+    page_id = next_page_id_++;
+    Preallocate();
+  } else {
+    num_free_pages_--;
+  }
+  MarkPages(page_id, 1, true);
+  last_allocated_page_id_ = page_id;
+  return page_id;
+}
+
+/**
+ * Allocate a run of consecutive pages (a table or an index reserving room to grow)
+ */
+page_id_t DiskManager::AllocateExtent(size_t num_pages) {
+  if (IsReadOnly()) {
+    LOG_DEBUG("allocating an extent in a read-only db file");
+    return INVALID_PAGE_ID;
+  }
+  BUSTUB_ASSERT(num_pages > 0, "An extent needs at least one page.");
+  std::scoped_lock lock(allocation_latch_);
+  page_id_t first_page_id = num_free_pages_ > 0 ? FindFreeRun(num_pages) : next_page_id_;
+  auto end_page_id = static_cast<page_id_t>(first_page_id + num_pages);
+  // the pages of the run below next_page_id_ are all free ones
+  num_free_pages_ -= std::min(end_page_id, next_page_id_) - first_page_id;
+  if (end_page_id > next_page_id_) {
+    next_page_id_ = end_page_id;
+    Preallocate();
+  }
+  MarkPages(first_page_id, num_pages, true);
+  last_allocated_page_id_ = end_page_id - 1;
+  return first_page_id;
+}
+
+/**
+ * Deallocate page (operations like drop index/table), for a later allocation to reuse
+ */
+void DiskManager::DeallocatePage(page_id_t page_id) {
+  if (IsReadOnly()) {
+    LOG_DEBUG("deallocating a page in a read-only db file");
+    return;
+  }
+  std::scoped_lock lock(allocation_latch_);
+  if (page_id < 0 || page_id >= next_page_id_ || (bitmap_[page_id / 64] & (uint64_t{1} << (page_id % 64))) == 0) {
+    LOG_DEBUG("deallocating page %d, which is not allocated", page_id);
+    return;
+  }
+  MarkPages(page_id, 1, false);
+  num_free_pages_++;
+}
 
 /**
- * Deallocate page (operations like drop index/table)
- * Need bitmap in header page for tracking pages
- * This does not actually need to do anything for now.
+ * Returns number of deallocated pages waiting to be reused
  */
-void DiskManager::DeallocatePage(__attribute__((unused)) page_id_t page_id) {}
+size_t DiskManager::GetNumFreePages() {
+  std::scoped_lock lock(allocation_latch_);
+  return num_free_pages_;
+}
 
 /**
  * Returns number of flushes made so far
@@ -207,18 +560,444 @@ int DiskManager::GetNumFlushes() const { return num_flushes_; }
  */
 int DiskManager::GetNumWrites() const { return num_writes_; }
 
+/**
+ * Returns number of Syncs made so far
+ */
+int DiskManager::GetNumSyncs() const { return num_syncs_; }
+
+/**
+ * Set what to do with checksums
+ */
+void DiskManager::SetChecksumPolicy(ChecksumPolicy checksum_policy, PageRepairHandler repair_handler) {
+  std::scoped_lock lock(checksum_latch_);
+  repair_handler_ = std::move(repair_handler);
+  checksum_policy_ = checksum_policy;
+}
+
+/**
+ * Returns number of pages read that did not match their checksum
+ */
+int DiskManager::GetNumChecksumFailures() const { return num_checksum_failures_; }
+
+/**
+ * Get a page in the mapping of the read-only database file
+ */
+const char *DiskManager::GetMappedPage(page_id_t page_id) {
+  if (mapping_ == nullptr || page_id < 0 || (static_cast<size_t>(page_id) + 1) * PAGE_SIZE > mapping_size_) {
+    return nullptr;
+  }
+  const char *page_data = mapping_ + static_cast<size_t>(page_id) * PAGE_SIZE;
+  return ChecksumMatches(page_id, page_data) ? page_data : nullptr;
+}
+
+/**
+ * Hint that pages of the mapping will be read soon
+ */
+void DiskManager::AdviseWillNeed(page_id_t page_id, size_t num_pages) {
+  if (mapping_ == nullptr || page_id < 0 || static_cast<size_t>(page_id) * PAGE_SIZE >= mapping_size_) {
+    return;
+  }
+  size_t offset = static_cast<size_t>(page_id) * PAGE_SIZE;
+  madvise(mapping_ + offset, std::min(num_pages * PAGE_SIZE, mapping_size_ - offset), MADV_WILLNEED);
+}
+
+/**
+ * Hint that the mapping is read sequentially
+ */
+void DiskManager::BeginSequentialAccess() {
+  std::scoped_lock lock(mapping_latch_);
+  if (mapping_ != nullptr && num_sequential_accesses_++ == 0) {
+    madvise(mapping_, mapping_size_, MADV_SEQUENTIAL);
+  }
+}
+
+/**
+ * End a sequential access to the mapping
+ */
+void DiskManager::EndSequentialAccess() {
+  std::scoped_lock lock(mapping_latch_);
+  if (mapping_ != nullptr && --num_sequential_accesses_ == 0) {
+    madvise(mapping_, mapping_size_, MADV_NORMAL);
+  }
+}
+
 /**
  * Returns true if the log is currently being flushed
  */
 bool DiskManager::GetFlushState() const { return flush_log_; }
 
+/**
+ * Private helper function to load the allocation bitmap and restore next_page_id_ from it. A bitmap left over from a
+ * deleted database file is discarded; a database file without a bitmap has all of its pages allocated.
+ */
+void DiskManager::LoadBitmap(bool db_file_existed) {
+  bool bitmap_existed = access(bitmap_name_.c_str(), F_OK) == 0;
+  bitmap_fd_ = open(bitmap_name_.c_str(), O_RDWR | O_CREAT | (db_file_existed ? 0 : O_TRUNC), 0644);
+  if (bitmap_fd_ < 0) {
+    throw Exception("can't open bitmap file");
+  }
+  struct stat stat_buf;
+  fstat(bitmap_fd_, &stat_buf);
+  size_t num_bitmap_pages = stat_buf.st_size / PAGE_SIZE;
+  bitmap_.resize(num_bitmap_pages * BITMAP_PAGE_WORDS);
+  for (size_t i = 0; i < num_bitmap_pages; ++i) {
+    ReadPageAt(bitmap_fd_, static_cast<page_id_t>(i), reinterpret_cast<char *>(&bitmap_[i * BITMAP_PAGE_WORDS]));
+  }
+
+  next_page_id_ = 0;
+  if (db_file_existed && !bitmap_existed) {
+    fstat(db_fd_, &stat_buf);
+    page_id_t num_pages = static_cast<page_id_t>((stat_buf.st_size + PAGE_SIZE - 1) / PAGE_SIZE);
+    if (num_pages > 0) {
+      bitmap_.resize(((num_pages - 1) / BITMAP_PAGE_BITS + 1) * BITMAP_PAGE_WORDS);
+      for (page_id_t page_id = 0; page_id < num_pages; ++page_id) {
+        bitmap_[page_id / 64] |= uint64_t{1} << (page_id % 64);
+      }
+      for (size_t i = 0; i < bitmap_.size() / BITMAP_PAGE_WORDS; ++i) {
+        WritePageAt(bitmap_fd_, static_cast<page_id_t>(i), reinterpret_cast<char *>(&bitmap_[i * BITMAP_PAGE_WORDS]));
+      }
+    }
+    next_page_id_ = num_pages;
+    return;
+  }
+  for (size_t word = bitmap_.size(); word > 0; --word) {
+    if (bitmap_[word - 1] != 0) {
+      next_page_id_ = static_cast<page_id_t>((word - 1) * 64 + 64 - __builtin_clzll(bitmap_[word - 1]));
+      break;
+    }
+  }
+  for (size_t word = 0; word < (static_cast<size_t>(next_page_id_) + 63) / 64; ++word) {
+    num_free_pages_ += 64 - __builtin_popcountll(bitmap_[word]);
+  }
+  // the bits past next_page_id_ in its word are unallocated, not free
+  num_free_pages_ -= (64 - next_page_id_ % 64) % 64;
+}
+
+/**
+ * Private helper function to set or clear the bits of consecutive pages in the allocation bitmap, and write the bitmap
+ * pages changed through. The caller must hold allocation_latch_
+ */
+void DiskManager::MarkPages(page_id_t first_page_id, size_t num_pages, bool allocated) {
+  size_t end_page_id = first_page_id + num_pages;
+  if ((end_page_id + 63) / 64 > bitmap_.size()) {
+    bitmap_.resize(((end_page_id - 1) / BITMAP_PAGE_BITS + 1) * BITMAP_PAGE_WORDS);
+  }
+  for (size_t page_id = first_page_id; page_id < end_page_id; ++page_id) {
+    if (allocated) {
+      bitmap_[page_id / 64] |= uint64_t{1} << (page_id % 64);
+    } else {
+      bitmap_[page_id / 64] &= ~(uint64_t{1} << (page_id % 64));
+    }
+  }
+  for (size_t bitmap_page = first_page_id / BITMAP_PAGE_BITS; bitmap_page <= (end_page_id - 1) / BITMAP_PAGE_BITS;
+       ++bitmap_page) {
+    if (bitmap_fd_ >= 0 && !WritePageAt(bitmap_fd_, static_cast<page_id_t>(bitmap_page),
+                                        reinterpret_cast<char *>(&bitmap_[bitmap_page * BITMAP_PAGE_WORDS]))) {
+      LOG_DEBUG("I/O error while writing the allocation bitmap");
+    }
+  }
+}
+
+/**
+ * Private helper function to find the free page closest to a page, INVALID_PAGE_ID if there is none. The caller must
+ * hold allocation_latch_
+ */
+page_id_t DiskManager::FindFreePage(page_id_t near) {
+  size_t num_words = (static_cast<size_t>(next_page_id_) + 63) / 64;
+  near = std::clamp(near, 0, next_page_id_ - 1);
+  size_t near_word = near / 64;
+  for (size_t distance = 0; distance < num_words; ++distance) {
+    // the word of the page first, then the words after and before it, one more word away each time
+    for (size_t word : {near_word + distance, near_word - distance}) {
+      if (word >= num_words) {
+        continue;
+      }
+      uint64_t free = ~bitmap_[word];
+      if (word == num_words - 1 && next_page_id_ % 64 != 0) {
+        free &= (uint64_t{1} << (next_page_id_ % 64)) - 1;
+      }
+      if (free == 0) {
+        continue;
+      }
+      if (word > near_word) {
+        return static_cast<page_id_t>(word * 64 + __builtin_ctzll(free));
+      }
+      if (word < near_word) {
+        return static_cast<page_id_t>(word * 64 + 63 - __builtin_clzll(free));
+      }
+      // the closest free bit of the page's own word, above or below it
+      int bit = near % 64;
+      uint64_t above = free & (~uint64_t{0} << bit);
+      uint64_t below = free & ((uint64_t{1} << bit) - 1);
+      int above_bit = above != 0 ? __builtin_ctzll(above) : 128;
+      int below_bit = below != 0 ? 63 - __builtin_clzll(below) : -128;
+      return static_cast<page_id_t>(word * 64 + (above_bit - bit <= bit - below_bit ? above_bit : below_bit));
+    }
+  }
+  return INVALID_PAGE_ID;
+}
+
+/**
+ * Private helper function to find the first run of free pages long enough for an extent, where the free pages at the
+ * end of the file run on into the unallocated pages past it. The caller must hold allocation_latch_
+ */
+page_id_t DiskManager::FindFreeRun(size_t num_pages) {
+  page_id_t run_start = 0;
+  page_id_t page_id = 0;
+  while (page_id < next_page_id_) {
+    uint64_t word = bitmap_[page_id / 64];
+    // whole words at a time where they are all allocated or all free
+    if (page_id % 64 == 0 && page_id + 64 <= next_page_id_ && (word == 0 || word == ~uint64_t{0})) {
+      page_id += 64;
+      if (word != 0) {
+        run_start = page_id;
+      } else if (static_cast<size_t>(page_id - run_start) >= num_pages) {
+        return run_start;
+      }
+      continue;
+    }
+    page_id++;
+    if ((word & (uint64_t{1} << ((page_id - 1) % 64))) != 0) {
+      run_start = page_id;
+    } else if (static_cast<size_t>(page_id - run_start) >= num_pages) {
+      return run_start;
+    }
+  }
+  return run_start;
+}
+
+/**
+ * Private helper function to reserve the file space of the pages up to next_page_id_, a large chunk at a time, without
+ * changing the file size. The caller must hold allocation_latch_
+ */
+void DiskManager::Preallocate() {
+  if (!preallocation_supported_ || next_page_id_ <= num_preallocated_pages_) {
+    return;
+  }
+  page_id_t end_page_id = (next_page_id_ + PREALLOCATION_SIZE - 1) / PREALLOCATION_SIZE * PREALLOCATION_SIZE;
+  if (fallocate(db_fd_, FALLOC_FL_KEEP_SIZE, static_cast<off_t>(num_preallocated_pages_) * PAGE_SIZE,
+                static_cast<off_t>(end_page_id - num_preallocated_pages_) * PAGE_SIZE) != 0) {
+    // the file system cannot preallocate, pages get their space when first written
+    LOG_DEBUG("can't preallocate db file");
+    preallocation_supported_ = false;
+    return;
+  }
+  num_preallocated_pages_ = end_page_id;
+}
+
+/**
+ * Private helper function to load the checksums. Checksums left over from a deleted database file are discarded
+ */
+void DiskManager::LoadChecksums(bool db_file_existed) {
+  if (IsReadOnly()) {
+    // a read-only db file without checksums has its pages unverified
+    checksum_fd_ = open(checksum_name_.c_str(), O_RDONLY);
+    if (checksum_fd_ < 0) {
+      return;
+    }
+  } else {
+    checksum_fd_ = open(checksum_name_.c_str(), O_RDWR | O_CREAT | (db_file_existed ? 0 : O_TRUNC), 0644);
+  }
+  if (checksum_fd_ < 0) {
+    throw Exception("can't open checksum file");
+  }
+  // the checksums of a session that crashed are kept as well, they match the pages whether their last write made it
+  // to the disk or not
+  struct stat stat_buf;
+  fstat(checksum_fd_, &stat_buf);
+  checksums_.resize(stat_buf.st_size / sizeof(PageChecksums));
+  size_t size = checksums_.size() * sizeof(PageChecksums);
+  size_t read_count = 0;
+  while (read_count < size) {
+    ssize_t rc = pread(checksum_fd_, reinterpret_cast<char *>(checksums_.data()) + read_count, size - read_count,
+                       static_cast<off_t>(read_count));
+    if (rc < 0 && errno == EINTR) {
+      continue;
+    }
+    if (rc <= 0) {
+      // pages whose checksums cannot be read are not verified
+      LOG_DEBUG("I/O error while reading the checksums");
+      checksums_.resize(read_count / sizeof(PageChecksums));
+      break;
+    }
+    read_count += rc;
+  }
+}
+
+/**
+ * Private helper function to record the checksums of pages about to be written, in ascending page id order, next to
+ * their previous ones, and sync them to the checksum file. The pages must not be written unless it succeeds
+ */
+bool DiskManager::RecordChecksums(const std::vector<PageWrite> &pages) {
+  // 0 stands for no checksum, a page whose checksum happens to be 0 goes unverified
+  std::vector<uint32_t> checksums(pages.size(), 0);
+  if (checksum_policy_ != ChecksumPolicy::NONE) {
+    for (size_t i = 0; i < pages.size(); ++i) {
+      checksums[i] = Crc32cUtil::Crc32c(pages[i].data_, PAGE_SIZE);
+    }
+  }
+  int checksum_fd;
+  {
+    std::scoped_lock lock(checksum_latch_);
+    std::set<page_id_t> changed;
+    for (size_t i = 0; i < pages.size(); ++i) {
+      auto page_id = static_cast<size_t>(pages[i].page_id_);
+      if (page_id >= checksums_.size()) {
+        if (checksums[i] == 0) {
+          continue;
+        }
+        checksums_.resize(page_id + 1, PageChecksums{0, 0});
+      }
+      PageChecksums &entry = checksums_[page_id];
+      if (entry.current_ != checksums[i]) {
+        entry = {entry.current_, checksums[i]};
+        changed.insert(pages[i].page_id_);
+      }
+    }
+    if (changed.empty() || checksum_fd_ < 0) {
+      return true;
+    }
+    if (!WriteChecksums(changed)) {
+      return false;
+    }
+    checksum_fd = checksum_fd_;
+  }
+  // synced outside the latch, so that writers sync their checksums at once
+  return fdatasync(checksum_fd) == 0;
+}
+
+/**
+ * Private helper function to drop the previous checksums of consecutive pages whose write completed. The checksum
+ * file keeps them until the pages are synced
+ */
+void DiskManager::CompleteChecksums(page_id_t first_page_id, size_t num_pages) {
+  auto first = static_cast<size_t>(first_page_id);
+  std::scoped_lock lock(checksum_latch_);
+  for (size_t i = first; i < std::min(first + num_pages, checksums_.size()); ++i) {
+    if (checksums_[i].previous_ != checksums_[i].current_) {
+      checksums_[i].previous_ = checksums_[i].current_;
+      completed_checksums_.insert(static_cast<page_id_t>(i));
+    }
+  }
+}
+
+/**
+ * Private helper function to write the checksums of the given pages to the checksum file, coalescing consecutive
+ * pages. The caller must hold checksum_latch_
+ */
+bool DiskManager::WriteChecksums(const std::set<page_id_t> &page_ids) {
+  auto it = page_ids.begin();
+  while (it != page_ids.end()) {
+    auto first = static_cast<size_t>(*it);
+    size_t end = first;
+    while (it != page_ids.end() && static_cast<size_t>(*it) == end && end < checksums_.size()) {
+      ++end;
+      ++it;
+    }
+    if (end == first) {
+      // past the checksums kept, which only grow
+      ++it;
+      continue;
+    }
+    const char *data = reinterpret_cast<const char *>(&checksums_[first]);
+    size_t size = (end - first) * sizeof(PageChecksums);
+    auto offset = static_cast<off_t>(first * sizeof(PageChecksums));
+    while (size > 0) {
+      ssize_t rc = pwrite(checksum_fd_, data, size, offset);
+      if (rc < 0 && errno == EINTR) {
+        continue;
+      }
+      if (rc <= 0) {
+        LOG_DEBUG("I/O error while writing the checksums");
+        return false;
+      }
+      data += rc;
+      size -= rc;
+      offset += rc;
+    }
+  }
+  return true;
+}
+
+/**
+ * Private helper function to check a page read against its checksum, true if there is nothing to check
+ */
+bool DiskManager::ChecksumMatches(page_id_t page_id, const char *page_data) {
+  if (checksum_policy_ == ChecksumPolicy::NONE) {
+    return true;
+  }
+  PageChecksums expected{0, 0};
+  {
+    std::scoped_lock lock(checksum_latch_);
+    if (static_cast<size_t>(page_id) < checksums_.size()) {
+      expected = checksums_[page_id];
+    }
+  }
+  // the page may be as it was before the write in flight or as written
+  if (expected.previous_ == 0 || expected.current_ == 0) {
+    return true;
+  }
+  uint32_t checksum = Crc32cUtil::Crc32c(page_data, PAGE_SIZE);
+  return checksum == expected.current_ || checksum == expected.previous_;
+}
+
+/**
+ * Private helper function to verify the checksum of a page read and apply the checksum policy to a mismatch
+ */
+bool DiskManager::VerifyChecksum(page_id_t page_id, char *page_data) {
+  ChecksumPolicy checksum_policy = checksum_policy_;
+  if (ChecksumMatches(page_id, page_data)) {
+    return true;
+  }
+  PageRepairHandler repair_handler;
+  {
+    std::scoped_lock lock(checksum_latch_);
+    repair_handler = repair_handler_;
+  }
+  num_checksum_failures_ += 1;
+  switch (checksum_policy) {
+    case ChecksumPolicy::LOG:
+      LOG_WARN("checksum mismatch on page %d", page_id);
+      return true;
+    case ChecksumPolicy::REPAIR:
+      if (repair_handler && repair_handler(page_id, page_data)) {
+        LOG_WARN("checksum mismatch on page %d, repaired", page_id);
+        WritePage(page_id, page_data);
+        return true;
+      }
+      LOG_WARN("checksum mismatch on page %d, which could not be repaired", page_id);
+      return false;
+    default:
+      LOG_WARN("checksum mismatch on page %d", page_id);
+      return false;
+  }
+}
+
+/**
+ * Private helper function to map the read-only database file, whose pages are then read with positional I/O if it
+ * cannot be mapped
+ */
+void DiskManager::MapFile() {
+  struct stat stat_buf;
+  if (fstat(db_fd_, &stat_buf) != 0 || stat_buf.st_size == 0) {
+    return;
+  }
+  void *mapping = mmap(nullptr, stat_buf.st_size, PROT_READ, MAP_SHARED, db_fd_, 0);
+  if (mapping == MAP_FAILED) {
+    LOG_DEBUG("can't map db file");
+    return;
+  }
+  mapping_ = static_cast<char *>(mapping);
+  mapping_size_ = stat_buf.st_size;
+}
+
 /**
  * Private helper function to get disk file size
  */
-int DiskManager::GetFileSize(const std::string &file_name) {
+int64_t DiskManager::GetFileSize(const std::string &file_name) {
   struct stat stat_buf;
   int rc = stat(file_name.c_str(), &stat_buf);
-  return rc == 0 ? static_cast<int>(stat_buf.st_size) : -1;
+  return rc == 0 ? static_cast<int64_t>(stat_buf.st_size) : -1;
 }
 
 }  // namespace bustub
@@ -0,0 +1,36 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// extent_allocator.cpp
+//
+// Identification: src/storage/disk/extent_allocator.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/extent_allocator.h"
+
+namespace bustub {
+
+ExtentAllocator::~ExtentAllocator() {
+  for (page_id_t page_id = next_page_id_; page_id < end_page_id_; ++page_id) {
+    disk_manager_->DeallocatePage(page_id);
+  }
+}
+
+page_id_t ExtentAllocator::AllocatePage() {
+  std::scoped_lock lock(latch_);
+  if (next_page_id_ == end_page_id_) {
+    page_id_t first_page_id = disk_manager_->AllocateExtent(extent_size_);
+    if (first_page_id == INVALID_PAGE_ID) {
+      return INVALID_PAGE_ID;
+    }
+    next_page_id_ = first_page_id;
+    end_page_id_ = static_cast<page_id_t>(first_page_id + extent_size_);
+  }
+  return next_page_id_++;
+}
+
+}  // namespace bustub
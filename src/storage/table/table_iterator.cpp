@@ -16,8 +16,9 @@
 
 namespace bustub {
 
-TableIterator::TableIterator(TableHeap *table_heap, RID rid, Transaction *txn)
-    : table_heap_(table_heap), tuple_(new Tuple(rid)), txn_(txn) {
+TableIterator::TableIterator(TableHeap *table_heap, RID rid, Transaction *txn,
+                             std::shared_ptr<BufferAccessStrategy> strategy)
+    : table_heap_(table_heap), tuple_(new Tuple(rid)), txn_(txn), strategy_(std::move(strategy)) {
   if (rid.GetPageId() != INVALID_PAGE_ID) {
     table_heap_->GetTuple(tuple_->rid_, tuple_, txn_);
   }
@@ -35,20 +36,20 @@ Tuple *TableIterator::operator->() {
 
 TableIterator &TableIterator::operator++() {
   BufferPoolManager *buffer_pool_manager = table_heap_->buffer_pool_manager_;
-  auto cur_page = static_cast<TablePage *>(buffer_pool_manager->FetchPage(tuple_->rid_.GetPageId()));
-  cur_page->RLatch();
-  assert(cur_page != nullptr);  // all pages are pinned
+  auto cur_page = buffer_pool_manager->FetchPageRead(tuple_->rid_.GetPageId(), strategy_.get());
+  assert(cur_page.IsValid());  // all pages are pinned
 
   RID next_tuple_rid;
-  if (!cur_page->GetNextTupleRid(tuple_->rid_,
-                                 &next_tuple_rid)) {  // end of this page
-    while (cur_page->GetNextPageId() != INVALID_PAGE_ID) {
-      auto next_page = static_cast<TablePage *>(buffer_pool_manager->FetchPage(cur_page->GetNextPageId()));
-      cur_page->RUnlatch();
-      buffer_pool_manager->UnpinPage(cur_page->GetTablePageId(), false);
-      cur_page = next_page;
-      cur_page->RLatch();
-      if (cur_page->GetFirstTupleRid(&next_tuple_rid)) {
+  if (!cur_page.As<TablePage>()->GetNextTupleRid(tuple_->rid_, &next_tuple_rid)) {  // end of this page
+    while (cur_page.As<TablePage>()->GetNextPageId() != INVALID_PAGE_ID) {
+      // Pin the next page before releasing the current one, but never hold both latches.
+      auto next_page = buffer_pool_manager->FetchPageBasic(cur_page.As<TablePage>()->GetNextPageId(), strategy_.get());
+      cur_page.Drop();
+      cur_page = next_page.UpgradeRead();
+      if (pages_ahead_ > 0) {
+        pages_ahead_--;
+      }
+      if (cur_page.As<TablePage>()->GetFirstTupleRid(&next_tuple_rid)) {
         break;
       }
     }
@@ -58,12 +59,38 @@ TableIterator &TableIterator::operator++() {
   if (*this != table_heap_->End()) {
     table_heap_->GetTuple(tuple_->rid_, tuple_, txn_);
   }
-  // release until copy the tuple
-  cur_page->RUnlatch();
-  buffer_pool_manager->UnpinPage(cur_page->GetTablePageId(), false);
+  ReadAhead(cur_page.As<TablePage>());
+  // cur_page is only released here, after the tuple was copied
   return *this;
 }
 
+void TableIterator::ReadAhead(const TablePage *cur_page) {
+  BufferPoolManager *buffer_pool_manager = table_heap_->buffer_pool_manager_;
+  if (pages_ahead_ == 0) {
+    read_ahead_page_id_ = cur_page->GetTablePageId();
+  }
+  while (pages_ahead_ < TABLE_READ_AHEAD_WINDOW) {
+    page_id_t next_page_id;
+    if (read_ahead_page_id_ == cur_page->GetTablePageId()) {
+      next_page_id = cur_page->GetNextPageId();
+    } else {
+      // Never wait for a prefetch in progress, the window grows on a later call instead.
+      Page *page = buffer_pool_manager->TryFetchPage(read_ahead_page_id_);
+      if (page == nullptr) {
+        return;
+      }
+      page->RLatch();
+      next_page_id = ReadPageGuard(buffer_pool_manager, page).As<TablePage>()->GetNextPageId();
+    }
+    if (next_page_id == INVALID_PAGE_ID) {
+      return;
+    }
+    buffer_pool_manager->PrefetchPage(next_page_id, strategy_);
+    read_ahead_page_id_ = next_page_id;
+    pages_ahead_++;
+  }
+}
+
 TableIterator TableIterator::operator++(int) {
   TableIterator clone(*this);
   ++(*this);
@@ -0,0 +1,108 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// arc_replacer_test.cpp
+//
+// Identification: test/buffer/arc_replacer_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/arc_replacer.h"
+
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+TEST(ARCReplacerTest, SampleTest) {
+  ARCReplacer arc_replacer(7);
+
+  // Scenario: access frames 1 to 6 once, then access 1 and 2 again.
+  for (frame_id_t i = 1; i <= 6; ++i) {
+    arc_replacer.Pin(i);
+    arc_replacer.Unpin(i);
+  }
+  arc_replacer.Pin(1);
+  arc_replacer.Unpin(1);
+  arc_replacer.Pin(2);
+  arc_replacer.Unpin(2);
+  EXPECT_EQ(6, arc_replacer.Size());
+
+  // Scenario: frames referenced once go first, least recently referenced first.
+  int value;
+  arc_replacer.Victim(&value);
+  EXPECT_EQ(3, value);
+  arc_replacer.Victim(&value);
+  EXPECT_EQ(4, value);
+
+  // Scenario: pinned frames are not victimized, unpinning a frame twice has no effect.
+  arc_replacer.Pin(5);
+  arc_replacer.Unpin(1);
+  EXPECT_EQ(3, arc_replacer.Size());
+
+  // Scenario: frame 6 is the last frame referenced once, then the frames referenced again go in order.
+  arc_replacer.Victim(&value);
+  EXPECT_EQ(6, value);
+  arc_replacer.Victim(&value);
+  EXPECT_EQ(1, value);
+  arc_replacer.Victim(&value);
+  EXPECT_EQ(2, value);
+  EXPECT_FALSE(arc_replacer.Victim(&value));
+
+  // Scenario: frame 5 was referenced again when it was pinned.
+  arc_replacer.Unpin(5);
+  EXPECT_EQ(true, arc_replacer.Remove(5));
+  EXPECT_EQ(false, arc_replacer.Remove(5));
+  EXPECT_EQ(0, arc_replacer.Size());
+}
+
+TEST(ARCReplacerTest, AdaptTest) {
+  ARCReplacer arc_replacer(4);
+
+  // Scenario: load pages 100 to 103 into frames 0 to 3, then reference frames 0 and 1 again.
+  for (frame_id_t i = 0; i < 4; ++i) {
+    arc_replacer.ReplacePage(i, INVALID_PAGE_ID, 100 + i);
+    arc_replacer.Pin(i);
+    arc_replacer.Unpin(i);
+  }
+  for (frame_id_t i = 0; i < 2; ++i) {
+    arc_replacer.Pin(i);
+    arc_replacer.Unpin(i);
+  }
+  EXPECT_EQ(0, arc_replacer.GetRecencyTarget());
+
+  // Scenario: page 102 is evicted from the recency list, then loaded again, which grows the recency list.
+  int value;
+  arc_replacer.Victim(&value);
+  EXPECT_EQ(2, value);
+  arc_replacer.ReplacePage(2, 102, 104);
+  arc_replacer.Unpin(2);
+  arc_replacer.Victim(&value);
+  EXPECT_EQ(3, value);
+  arc_replacer.ReplacePage(3, 103, 102);
+  arc_replacer.Unpin(3);
+  EXPECT_EQ(1, arc_replacer.GetRecencyTarget());
+
+  // Scenario: the recency list holds no more than its target, the victim comes from the frequency list.
+  arc_replacer.Victim(&value);
+  EXPECT_EQ(0, value);
+
+  // Scenario: page 100 is loaded again after its eviction from the frequency list, which shrinks the recency list.
+  arc_replacer.ReplacePage(0, 100, 105);
+  arc_replacer.Unpin(0);
+  arc_replacer.Victim(&value);
+  EXPECT_EQ(2, value);
+  arc_replacer.ReplacePage(2, 104, 100);
+  arc_replacer.Unpin(2);
+  EXPECT_EQ(0, arc_replacer.GetRecencyTarget());
+
+  // Scenario: pages loaded from a ghost list are in the frequency list, which goes after frame 0 of the recency list.
+  arc_replacer.Victim(&value);
+  EXPECT_EQ(0, value);
+  arc_replacer.Victim(&value);
+  EXPECT_EQ(1, value);
+}
+
+}  // namespace bustub
@@ -11,9 +11,20 @@
 //===----------------------------------------------------------------------===//
 
 #include "buffer/buffer_pool_manager.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <atomic>
+#include <chrono>  // NOLINT
 #include <cstdio>
+#include <cstring>
+#include <iostream>
 #include <random>
 #include <string>
+#include <thread>  // NOLINT
+#include <vector>
+#include "common/util/crc32c_util.h"
 #include "gtest/gtest.h"
 
 namespace bustub {
@@ -141,4 +152,1280 @@ TEST(BufferPoolManagerTest, SampleTest) {
   delete disk_manager;
 }
 
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, ClockReplacerTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm =
+      new BufferPoolManager(buffer_pool_size, disk_manager, nullptr, BufferPoolManager::ReplacerType::CLOCK);
+
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "Page %d", page_id_temp);
+  }
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+
+  // Scenario: After unpinning pages {0, 1, 2, 3, 4} and creating 4 new pages, one frame is left for reading page 0
+  // back from disk.
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_EQ(true, bpm->UnpinPage(i, true));
+  }
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  }
+  auto *page0 = bpm->FetchPage(0);
+  ASSERT_NE(nullptr, page0);
+  EXPECT_EQ(0, strcmp(page0->GetData(), "Page 0"));
+
+  // Scenario: Every frame is pinned again.
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+  EXPECT_EQ(nullptr, bpm->FetchPage(1));
+
+  // Scenario: Evicted dirty pages were written back.
+  EXPECT_EQ(true, bpm->UnpinPage(0, false));
+  auto *page1 = bpm->FetchPage(1);
+  ASSERT_NE(nullptr, page1);
+  EXPECT_EQ(0, strcmp(page1->GetData(), "Page 1"));
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, ARCReplacerTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 4;
+  const size_t num_stream_pages = 20;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager, nullptr, BufferPoolManager::ReplacerType::ARC);
+
+  // Scenario: Page 0 is referenced twice, then many pages are created and referenced once.
+  page_id_t page_id_temp;
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  EXPECT_EQ(true, bpm->UnpinPage(0, true));
+  ASSERT_NE(nullptr, bpm->FetchPage(0));
+  EXPECT_EQ(true, bpm->UnpinPage(0, false));
+  for (size_t i = 0; i < num_stream_pages; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+
+  // Scenario: The pages referenced once were evicted in turn, page 0 stayed in the pool.
+  EXPECT_EQ(num_stream_pages - (buffer_pool_size - 1), bpm->GetStats().evictions_);
+  ASSERT_NE(nullptr, bpm->FetchPage(0));
+  EXPECT_EQ(true, bpm->UnpinPage(0, false));
+  EXPECT_EQ(0U, bpm->GetStats().GetMisses());
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, FlushTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "Page %d", page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+
+  // Scenario: Flushing a page writes it once, flushing a page that is not in the pool fails.
+  EXPECT_EQ(true, bpm->FlushPage(0));
+  EXPECT_EQ(1, disk_manager->GetNumWrites());
+  EXPECT_EQ(false, bpm->FlushPage(static_cast<page_id_t>(buffer_pool_size)));
+
+  // Scenario: Flushing all pages writes every page of the pool and syncs once, after which evictions write nothing.
+  EXPECT_EQ(0, disk_manager->GetNumSyncs());
+  bpm->FlushAllPages();
+  EXPECT_EQ(static_cast<int>(buffer_pool_size + 1), disk_manager->GetNumWrites());
+  EXPECT_EQ(1, disk_manager->GetNumSyncs());
+  EXPECT_EQ(buffer_pool_size + 1, bpm->GetNumForegroundWrites());
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+  }
+  EXPECT_EQ(static_cast<int>(buffer_pool_size + 1), disk_manager->GetNumWrites());
+
+  // Scenario: The flushed pages can be read back.
+  for (page_id_t i = 0; i < static_cast<page_id_t>(buffer_pool_size); ++i) {
+    auto *page = bpm->FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(0, strcmp(page->GetData(), ("Page " + std::to_string(i)).c_str()));
+    EXPECT_EQ(true, bpm->UnpinPage(i, false));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, DeletePageTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "Page %d", page_id_temp);
+  }
+
+  // Scenario: A pinned page cannot be deleted, an unpinned one can, and frees its frame without being written.
+  EXPECT_EQ(false, bpm->DeletePage(3));
+  EXPECT_EQ(true, bpm->UnpinPage(3, true));
+  EXPECT_EQ(true, bpm->DeletePage(3));
+  EXPECT_EQ(1, disk_manager->GetNumFreePages());
+  EXPECT_EQ(0, disk_manager->GetNumWrites());
+
+  // Scenario: The next new page reuses both the frame and the page id, even though every other frame is pinned.
+  auto *page = bpm->NewPage(&page_id_temp);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(3, page_id_temp);
+  EXPECT_EQ(0, page->GetData()[0]);
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+
+  // Scenario: Deleting a page that is not in the pool deallocates it.
+  for (page_id_t i = 0; i < static_cast<page_id_t>(buffer_pool_size); ++i) {
+    EXPECT_EQ(true, bpm->UnpinPage(i, true));
+  }
+  bpm->FlushAllPages();
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+  }
+  EXPECT_EQ(nullptr, bpm->TryFetchPage(5));
+  EXPECT_EQ(true, bpm->DeletePage(5));
+  EXPECT_EQ(1, disk_manager->GetNumFreePages());
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  EXPECT_EQ(5, page_id_temp);
+  EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+
+  // Scenario: The new page on the reused id is evicted before anyone writes to it, and reads back as zeroes, not as the
+  // deleted page.
+  std::vector<page_id_t> page_ids;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    page_ids.push_back(page_id_temp);
+  }
+  for (page_id_t page_id : page_ids) {
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+  page = bpm->FetchPage(5);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(std::string(PAGE_SIZE, '\0'), std::string(page->GetData(), PAGE_SIZE));
+  EXPECT_EQ(true, bpm->UnpinPage(5, false));
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, CorruptPageTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+
+  auto *disk_manager = new DiskManager(db_name);
+  disk_manager->SetChecksumPolicy(ChecksumPolicy::FAIL);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < buffer_pool_size * 2; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "Page %d", page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+
+  // Scenario: Pages 0 to 2 were evicted, then corrupted on disk.
+  FILE *file = fopen(db_name.c_str(), "r+b");
+  ASSERT_NE(nullptr, file);
+  for (page_id_t page_id = 0; page_id < 3; ++page_id) {
+    fseek(file, page_id * PAGE_SIZE + 1, SEEK_SET);
+    fputc('X', file);
+  }
+  fclose(file);
+
+  // Scenario: Fetching a corrupted page fails, and its frame goes back to the pool.
+  EXPECT_EQ(nullptr, bpm->FetchPage(0));
+  EXPECT_EQ(nullptr, bpm->FetchPage(0));
+  EXPECT_EQ(2, disk_manager->GetNumChecksumFailures());
+  std::vector<Page *> pages;
+  for (page_id_t page_id = 10; page_id < 20; ++page_id) {
+    pages.push_back(bpm->FetchPage(page_id));
+    ASSERT_NE(nullptr, pages.back());
+  }
+  for (page_id_t page_id = 10; page_id < 20; ++page_id) {
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+
+  // Scenario: A corrupted page is not prefetched, the page prefetched after it is.
+  bpm->PrefetchPages({1, 3});
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (bpm->GetNumPrefetches() < 1 && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  EXPECT_EQ(1, bpm->GetNumPrefetches());
+  EXPECT_EQ(nullptr, bpm->TryFetchPage(1));
+  ASSERT_NE(nullptr, bpm->TryFetchPage(3));
+  EXPECT_EQ(true, bpm->UnpinPage(3, false));
+
+  // Scenario: Under the LOG policy, the corrupted page is fetched as it is on disk.
+  disk_manager->SetChecksumPolicy(ChecksumPolicy::LOG);
+  auto *page2 = bpm->FetchPage(2);
+  ASSERT_NE(nullptr, page2);
+  EXPECT_EQ(0, strcmp(page2->GetData(), "PXge 2"));
+  EXPECT_EQ(true, bpm->UnpinPage(2, false));
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, BackgroundFlushTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+  const size_t clean_frames = 4;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "Page %d", page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+
+  // Scenario: The background flush thread writes back the dirty pages until the pool has enough clean frames.
+  bpm->RunBackgroundFlushThread(clean_frames);
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (bpm->GetNumBackgroundWrites() < clean_frames && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  bpm->StopBackgroundFlushThread();
+  EXPECT_EQ(clean_frames, bpm->GetNumBackgroundWrites());
+  EXPECT_EQ(0, bpm->GetNumForegroundWrites());
+
+  // Scenario: Pages are written in page id order without a log manager, so the least recently used pages are clean
+  // and evicting them costs the foreground nothing.
+  for (size_t i = 0; i < clean_frames; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+  }
+  EXPECT_EQ(0, bpm->GetNumForegroundWrites());
+  for (page_id_t i = 0; i < static_cast<page_id_t>(clean_frames); ++i) {
+    auto *page = bpm->FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(0, strcmp(page->GetData(), ("Page " + std::to_string(i)).c_str()));
+    EXPECT_EQ(true, bpm->UnpinPage(i, false));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, PrefetchTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+  const int num_prefetches = 5;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < buffer_pool_size * 2; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "Page %d", page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+
+  // Scenario: Pages 0 to 4 were evicted. Prefetching them loads them without pinning them.
+  EXPECT_EQ(nullptr, bpm->TryFetchPage(0));
+  std::vector<page_id_t> page_ids;
+  for (page_id_t i = 0; i < num_prefetches; ++i) {
+    page_ids.push_back(i);
+  }
+  bpm->PrefetchPages(page_ids);
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (bpm->GetNumPrefetches() < num_prefetches && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  EXPECT_EQ(num_prefetches, bpm->GetNumPrefetches());
+  for (page_id_t i = 0; i < num_prefetches; ++i) {
+    auto *page = bpm->TryFetchPage(i);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(1, page->GetPinCount());
+    EXPECT_EQ(0, strcmp(page->GetData(), ("Page " + std::to_string(i)).c_str()));
+    EXPECT_EQ(true, bpm->UnpinPage(i, false));
+  }
+
+  // Scenario: Prefetching a page that is already in the pool does nothing.
+  bpm->PrefetchPage(0);
+  auto *page0 = bpm->FetchPage(0);
+  ASSERT_NE(nullptr, page0);
+  EXPECT_EQ(true, bpm->UnpinPage(0, false));
+
+  // Scenario: A fetch racing with the prefetch of the same page sees the page's data.
+  for (page_id_t i = num_prefetches; i < static_cast<page_id_t>(buffer_pool_size * 2); ++i) {
+    bpm->PrefetchPage(i);
+    auto *page = bpm->FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(0, strcmp(page->GetData(), ("Page " + std::to_string(i)).c_str()));
+    EXPECT_EQ(true, bpm->UnpinPage(i, false));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, BufferAccessStrategyTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 20;
+  const size_t num_hot_pages = 10;
+  const size_t num_scan_pages = 100;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+
+  // Scenario: Create some hot, dirty pages. Evicting any of them would write it back.
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < num_hot_pages; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+
+  // Scenario: Load and scan many more pages than the pool holds through a ring of 4 frames.
+  BufferAccessStrategy strategy(4);
+  std::vector<page_id_t> scan_pages;
+  for (size_t i = 0; i < num_scan_pages; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp, &strategy);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "Scan %d", page_id_temp);
+    scan_pages.push_back(page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+  for (page_id_t page_id : scan_pages) {
+    auto *page = bpm->FetchPage(page_id, &strategy);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(0, strcmp(page->GetData(), ("Scan " + std::to_string(page_id)).c_str()));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+
+  // Scenario: Only the scan pages were written back, the hot pages never left the pool.
+  EXPECT_EQ(static_cast<int>(num_scan_pages), disk_manager->GetNumWrites());
+  for (page_id_t i = 0; i < static_cast<page_id_t>(num_hot_pages); ++i) {
+    ASSERT_NE(nullptr, bpm->FetchPage(i));
+    EXPECT_EQ(true, bpm->UnpinPage(i, false));
+  }
+  EXPECT_EQ(static_cast<int>(num_scan_pages), disk_manager->GetNumWrites());
+
+  // Scenario: Without a strategy, the same scan evicts the hot pages.
+  for (page_id_t page_id : scan_pages) {
+    ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+  EXPECT_EQ(static_cast<int>(num_scan_pages + num_hot_pages), disk_manager->GetNumWrites());
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, PartitionedSampleTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+  const size_t num_instances = 5;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, num_instances, disk_manager);
+  EXPECT_EQ(num_instances, bpm->GetNumInstances());
+  EXPECT_EQ(buffer_pool_size, bpm->GetPoolSize());
+
+  // Scenario: We should be able to create new pages until we fill up the buffer pool. Consecutive page ids are spread
+  // over the instances, so every instance is full at the same time.
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "Page %d", page_id_temp);
+  }
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+
+  // Scenario: Every page has its own frame.
+  for (page_id_t i = 0; i < static_cast<page_id_t>(buffer_pool_size); ++i) {
+    auto *page = bpm->FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(i, page->GetPageId());
+    EXPECT_EQ(2, page->GetPinCount());
+    EXPECT_EQ(0, strcmp(page->GetData(), ("Page " + std::to_string(i)).c_str()));
+    EXPECT_EQ(true, bpm->UnpinPage(i, false));
+  }
+
+  // Scenario: After unpinning everything, new pages evict the old ones and the old ones can be read back from disk.
+  for (page_id_t i = 0; i < static_cast<page_id_t>(buffer_pool_size); ++i) {
+    EXPECT_EQ(true, bpm->UnpinPage(i, true));
+  }
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+  }
+  for (page_id_t i = 0; i < static_cast<page_id_t>(buffer_pool_size); ++i) {
+    auto *page = bpm->FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(0, strcmp(page->GetData(), ("Page " + std::to_string(i)).c_str()));
+    EXPECT_EQ(true, bpm->UnpinPage(i, false));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, PartitionedConcurrentTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 64;
+  const int num_threads = 4;
+  const int num_ops = 1000;
+
+  for (size_t num_instances : {1, 4, 16}) {
+    auto *disk_manager = new DiskManager(db_name);
+    auto *bpm = new BufferPoolManager(buffer_pool_size, num_instances, disk_manager);
+
+    page_id_t page_id_temp;
+    for (size_t i = 0; i < buffer_pool_size; ++i) {
+      ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+      EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+    }
+
+    std::vector<std::thread> threads;
+    for (int tid = 0; tid < num_threads; ++tid) {
+      threads.emplace_back([bpm, tid, buffer_pool_size, num_ops] {
+        std::default_random_engine rng(tid);
+        std::uniform_int_distribution<page_id_t> uniform_dist(0, buffer_pool_size - 1);
+        for (int i = 0; i < num_ops; ++i) {
+          page_id_t page_id = uniform_dist(rng);
+          auto *page = bpm->FetchPage(page_id);
+          ASSERT_NE(nullptr, page);
+          EXPECT_EQ(page_id, page->GetPageId());
+          EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+
+    // Scenario: No pin was leaked by the concurrent fetches, whatever the number of instances.
+    for (page_id_t i = 0; i < static_cast<page_id_t>(buffer_pool_size); ++i) {
+      auto *page = bpm->FetchPage(i);
+      ASSERT_NE(nullptr, page);
+      EXPECT_EQ(1, page->GetPinCount());
+      EXPECT_EQ(true, bpm->UnpinPage(i, false));
+    }
+
+    disk_manager->ShutDown();
+    remove("test.db");
+
+    delete bpm;
+    delete disk_manager;
+  }
+}
+
+// A benchmark, run with --gtest_also_run_disabled_tests.
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, DISABLED_PartitionedThroughputBenchmarkTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 256;
+  const int num_threads = 8;
+  const int num_ops = 50000;
+
+  for (size_t num_instances : {1, 4, 16}) {
+    auto *disk_manager = new DiskManager(db_name);
+    auto *bpm = new BufferPoolManager(buffer_pool_size, num_instances, disk_manager);
+
+    // Every page fits in the pool, so the threads only measure hits.
+    page_id_t page_id_temp;
+    for (size_t i = 0; i < buffer_pool_size; ++i) {
+      ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+      EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (int tid = 0; tid < num_threads; ++tid) {
+      threads.emplace_back([bpm, tid, buffer_pool_size, num_ops] {
+        std::default_random_engine rng(tid);
+        std::uniform_int_distribution<page_id_t> uniform_dist(0, buffer_pool_size - 1);
+        for (int i = 0; i < num_ops; ++i) {
+          page_id_t page_id = uniform_dist(rng);
+          auto *page = bpm->FetchPage(page_id);
+          ASSERT_NE(nullptr, page);
+          EXPECT_EQ(page_id, page->GetPageId());
+          EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << num_instances << " instance(s): " << static_cast<int64_t>(num_threads * num_ops / elapsed.count())
+              << " fetch/unpin pairs per second" << std::endl;
+
+    disk_manager->ShutDown();
+    remove("test.db");
+
+    delete bpm;
+    delete disk_manager;
+  }
+}
+
+// A benchmark, run with --gtest_also_run_disabled_tests.
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, DISABLED_HitPathBenchmarkTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 16384;
+  const int num_ops = 1000000;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+
+  // Scenario: Page data is page-aligned, so a frame never straddles two pages of memory.
+  for (Page *page : bpm->GetPages()) {
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(page->GetData()) % PAGE_SIZE);
+  }
+
+  // Every page fits in the pool, and the fetches spread over all of it, so a hit touches cold metadata and data.
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+  }
+  std::default_random_engine rng(0);
+  std::uniform_int_distribution<page_id_t> uniform_dist(0, buffer_pool_size - 1);
+  int64_t checksum = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < num_ops; ++i) {
+    page_id_t page_id = uniform_dist(rng);
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    checksum += page->GetData()[PAGE_SIZE / 2];
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+  std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+  EXPECT_EQ(0, checksum);
+  std::cout << static_cast<int64_t>(elapsed.count() / num_ops) << " ns per fetch/unpin pair" << std::endl;
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// @return the number of bytes of a file held in the kernel page cache
+static size_t GetPageCacheFootprint(const std::string &file_name) {
+  int fd = open(file_name.c_str(), O_RDONLY);
+  struct stat stat_buf;
+  if (fd < 0 || fstat(fd, &stat_buf) != 0 || stat_buf.st_size == 0) {
+    return 0;
+  }
+  size_t os_page_size = sysconf(_SC_PAGESIZE);
+  size_t length = stat_buf.st_size;
+  void *file = mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  std::vector<unsigned char> resident((length + os_page_size - 1) / os_page_size);
+  mincore(file, length, resident.data());
+  munmap(file, length);
+  size_t num_resident = 0;
+  for (unsigned char r : resident) {
+    num_resident += r & 1;
+  }
+  return num_resident * os_page_size;
+}
+
+// @return the resident set size of the process, in bytes
+static size_t GetResidentSetSize() {
+  size_t size = 0;
+  size_t resident = 0;
+  FILE *statm = fopen("/proc/self/statm", "r");
+  if (statm != nullptr) {
+    if (fscanf(statm, "%zu %zu", &size, &resident) != 2) {
+      resident = 0;
+    }
+    fclose(statm);
+  }
+  return resident * sysconf(_SC_PAGESIZE);
+}
+
+// A benchmark, run with --gtest_also_run_disabled_tests.
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, DISABLED_DirectIOBenchmarkTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 256;
+  const int num_pages = 4096;
+  const int num_ops = 20000;
+
+  // Scenario: The working set is 16 times the pool, so most fetches miss. Buffered I/O serves the misses from the page
+  // cache, which holds a second copy of the working set; direct I/O reads the device and caches nothing twice.
+  for (auto page_io_mode : {PageIOMode::BUFFERED, PageIOMode::DIRECT}) {
+    remove(db_name.c_str());
+    auto *disk_manager = new DiskManager(db_name, page_io_mode);
+    auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+
+    page_id_t page_id_temp;
+    for (int i = 0; i < num_pages; ++i) {
+      auto *page = bpm->NewPage(&page_id_temp);
+      ASSERT_NE(nullptr, page);
+      snprintf(page->GetData(), PAGE_SIZE, "Page %d", page_id_temp);
+      EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+    }
+    bpm->FlushAllPages();
+
+    std::default_random_engine rng(0);
+    std::uniform_int_distribution<page_id_t> uniform_dist(0, num_pages - 1);
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < num_ops; ++i) {
+      page_id_t page_id = uniform_dist(rng);
+      auto *page = bpm->FetchPage(page_id);
+      ASSERT_NE(nullptr, page);
+      EXPECT_EQ(0, strcmp(page->GetData(), ("Page " + std::to_string(page_id)).c_str()));
+      EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    size_t page_cache_footprint = GetPageCacheFootprint(db_name);
+    std::cout << (disk_manager->GetPageIOMode() == PageIOMode::DIRECT ? "direct" : "buffered") << " I/O: "
+              << static_cast<int64_t>(num_ops / elapsed.count()) << " fetches per second, "
+              << GetResidentSetSize() / 1024 << " KiB resident, " << page_cache_footprint / 1024
+              << " KiB of the file in the page cache" << std::endl;
+    if (disk_manager->GetPageIOMode() == PageIOMode::DIRECT) {
+      EXPECT_LT(page_cache_footprint, static_cast<size_t>(num_pages) * PAGE_SIZE / 2);
+    }
+
+    disk_manager->ShutDown();
+    remove(db_name.c_str());
+
+    delete bpm;
+    delete disk_manager;
+  }
+}
+
+// A benchmark, run with --gtest_also_run_disabled_tests.
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, DISABLED_ChecksumBenchmarkTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 256;
+  const int num_pages = 4096;
+  const int num_ops = 20000;
+
+  // Scenario: The cost of a checksum alone, on the CPU's crc32 instruction if it has one.
+  std::vector<char> data(PAGE_SIZE * 256);
+  for (size_t i = 0; i < data.size(); ++i) {
+    data[i] = static_cast<char>(i % 251);
+  }
+  uint32_t checksum = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < num_ops; ++i) {
+    checksum ^= Crc32cUtil::Crc32c(&data[(i % 256) * PAGE_SIZE], PAGE_SIZE);
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  std::cout << (Crc32cUtil::IsHardwareAccelerated() ? "hardware" : "software") << " CRC32C: "
+            << static_cast<int64_t>(elapsed.count() * 1e9 / num_ops) << " ns per page" << std::endl;
+  EXPECT_NE(0, checksum);
+
+  // Scenario: Most fetches miss and read from the page cache, with and without verifying the checksum.
+  for (auto checksum_policy : {ChecksumPolicy::NONE, ChecksumPolicy::FAIL}) {
+    remove(db_name.c_str());
+    auto *disk_manager = new DiskManager(db_name);
+    disk_manager->SetChecksumPolicy(checksum_policy);
+    auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+
+    page_id_t page_id_temp;
+    for (int i = 0; i < num_pages; ++i) {
+      auto *page = bpm->NewPage(&page_id_temp);
+      ASSERT_NE(nullptr, page);
+      snprintf(page->GetData(), PAGE_SIZE, "Page %d", page_id_temp);
+      EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+    }
+    bpm->FlushAllPages();
+
+    std::default_random_engine rng(0);
+    std::uniform_int_distribution<page_id_t> uniform_dist(0, num_pages - 1);
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < num_ops; ++i) {
+      page_id_t page_id = uniform_dist(rng);
+      auto *page = bpm->FetchPage(page_id);
+      ASSERT_NE(nullptr, page);
+      EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+    }
+    elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << (checksum_policy == ChecksumPolicy::NONE ? "without" : "with") << " checksums: "
+              << static_cast<int64_t>(num_ops / elapsed.count()) << " fetches per second" << std::endl;
+    EXPECT_EQ(0, disk_manager->GetNumChecksumFailures());
+
+    disk_manager->ShutDown();
+    remove(db_name.c_str());
+
+    delete bpm;
+    delete disk_manager;
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, CheckpointTest) {
+  const std::string db_name = "test.db";
+  // more consecutive pages than a single vectored write takes
+  const int num_pages = 2500;
+  const page_id_t deleted_page_id = 1500;
+
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(num_pages, disk_manager);
+  page_id_t page_id_temp;
+  for (int i = 0; i < num_pages; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "Page %d", page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+  EXPECT_EQ(true, bpm->DeletePage(deleted_page_id));
+
+  // Scenario: A checkpoint writes every dirty page once, in runs of consecutive pages split at the deleted page.
+  bpm->FlushAllPages();
+  EXPECT_EQ(num_pages - 1, disk_manager->GetNumWrites());
+  EXPECT_EQ(1, disk_manager->GetNumSyncs());
+  delete bpm;
+
+  // Scenario: A new pool reads every page back as it was written.
+  bpm = new BufferPoolManager(64, disk_manager);
+  for (page_id_t page_id = 0; page_id < num_pages; ++page_id) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    if (page_id == deleted_page_id) {
+      EXPECT_EQ(0, page->GetData()[0]);
+    } else {
+      EXPECT_EQ(0, strcmp(page->GetData(), ("Page " + std::to_string(page_id)).c_str()));
+    }
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+  EXPECT_EQ(0, disk_manager->GetNumChecksumFailures());
+
+  disk_manager->ShutDown();
+  remove(db_name.c_str());
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// A benchmark, run with --gtest_also_run_disabled_tests.
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, DISABLED_CheckpointBenchmarkTest) {
+  const std::string db_name = "test.db";
+  const int num_pages = 100000;
+
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(num_pages, disk_manager);
+  page_id_t page_id_temp;
+  for (int i = 0; i < num_pages; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "Page %d", page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+  bpm->FlushAllPages();
+
+  // Scenario: Every page of the pool is dirty, then written by a checkpoint one page at a time, or in batches with a
+  // single write per run of consecutive pages.
+  for (bool batched : {false, true}) {
+    for (page_id_t page_id = 0; page_id < num_pages; ++page_id) {
+      auto *page = bpm->FetchPage(page_id);
+      ASSERT_NE(nullptr, page);
+      snprintf(page->GetData(), PAGE_SIZE, "Page %d, %s", page_id, batched ? "batched" : "one at a time");
+      EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+    }
+    int num_writes = disk_manager->GetNumWrites();
+    auto start = std::chrono::steady_clock::now();
+    if (batched) {
+      bpm->FlushAllPages();
+    } else {
+      for (page_id_t page_id = 0; page_id < num_pages; ++page_id) {
+        EXPECT_EQ(true, bpm->FlushPage(page_id));
+      }
+      disk_manager->Sync();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << (batched ? "batched" : "one page at a time") << ": " << static_cast<int64_t>(elapsed.count() * 1000)
+              << " ms to write " << num_pages << " dirty pages" << std::endl;
+    EXPECT_EQ(num_writes + num_pages, disk_manager->GetNumWrites());
+  }
+
+  disk_manager->ShutDown();
+  remove(db_name.c_str());
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, MmapReadOnlyTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 4;
+  const int num_pages = 10;
+
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+  page_id_t page_id_temp;
+  for (int i = 0; i < num_pages; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "Page %d", page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+  bpm->FlushAllPages();
+  disk_manager->ShutDown();
+  delete bpm;
+  delete disk_manager;
+
+  // Scenario: Fetched pages point into the mapping, also after their frame was used by other pages.
+  disk_manager = new DiskManager(db_name, PageIOMode::MMAP_READ_ONLY);
+  disk_manager->SetChecksumPolicy(ChecksumPolicy::FAIL);
+  bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+  for (int round = 0; round < 2; ++round) {
+    for (page_id_t page_id = 0; page_id < num_pages; ++page_id) {
+      auto *page = bpm->FetchPage(page_id);
+      ASSERT_NE(nullptr, page);
+      EXPECT_EQ(disk_manager->GetMappedPage(page_id), page->GetData());
+      EXPECT_EQ(0, strcmp(page->GetData(), ("Page " + std::to_string(page_id)).c_str()));
+      EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+    }
+  }
+
+  // Scenario: Pages cannot be latched for writing, written through a guard, deleted or unpinned dirty, their data being
+  // read-only.
+  EXPECT_EQ(false, bpm->FetchPageWrite(0).IsValid());
+  EXPECT_EQ(false, bpm->FetchPageBasic(0).UpgradeWrite().IsValid());
+  {
+    auto guard = bpm->FetchPageBasic(0);
+    ASSERT_EQ(true, guard.IsValid());
+    EXPECT_EQ(nullptr, guard.GetDataMut());
+    EXPECT_EQ(nullptr, guard.AsMut<char>());
+    EXPECT_EQ(nullptr, guard.AsMut<Page>());
+    EXPECT_EQ(disk_manager->GetMappedPage(0), guard.GetData());
+  }
+  EXPECT_EQ(false, bpm->DeletePage(0));
+  auto *page = bpm->FetchPage(0);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(false, bpm->UnpinPage(0, true));
+  EXPECT_EQ(false, page->IsDirty());
+  EXPECT_EQ(true, bpm->GetPinnedPages().empty());
+
+  // Scenario: Pages cannot be created, and nothing is written back.
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+  EXPECT_EQ(false, bpm->FlushPage(0));
+  bpm->FlushAllPages();
+  EXPECT_EQ(0, disk_manager->GetNumWrites());
+
+  // Scenario: A corrupted page is not handed out from the mapping, its copy fails the checksum.
+  FILE *file = fopen(db_name.c_str(), "r+b");
+  ASSERT_NE(nullptr, file);
+  fseek(file, 9 * PAGE_SIZE + 100, SEEK_SET);
+  fputc('z', file);
+  fclose(file);
+  for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(buffer_pool_size); ++page_id) {
+    ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+  EXPECT_EQ(nullptr, bpm->FetchPage(9));
+  EXPECT_EQ(1, disk_manager->GetNumChecksumFailures());
+
+  disk_manager->ShutDown();
+  remove(db_name.c_str());
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// A benchmark, run with --gtest_also_run_disabled_tests.
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, DISABLED_MmapScanBenchmarkTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 256;
+  const int num_pages = 16384;
+  const int num_scans = 4;
+
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+  page_id_t page_id_temp;
+  for (int i = 0; i < num_pages; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    std::memset(page->GetData(), i % 128, PAGE_SIZE);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+  bpm->FlushAllPages();
+  disk_manager->ShutDown();
+  delete bpm;
+  delete disk_manager;
+
+  // Scenario: Full scans of a file in the page cache, which the copying path reads into the frames of a scan ring, and
+  // the read-only mapped path hands out in place.
+  for (auto page_io_mode : {PageIOMode::BUFFERED, PageIOMode::MMAP_READ_ONLY}) {
+    disk_manager = new DiskManager(db_name, page_io_mode);
+    bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+    std::chrono::duration<double> elapsed{0};
+    for (int scan = 0; scan <= num_scans; ++scan) {
+      auto strategy = bpm->NewScanStrategy();
+      auto start = std::chrono::steady_clock::now();
+      int64_t sum = 0;
+      for (page_id_t page_id = 0; page_id < num_pages; ++page_id) {
+        auto *page = bpm->FetchPage(page_id, strategy.get());
+        ASSERT_NE(nullptr, page);
+        for (size_t offset = 0; offset < PAGE_SIZE; offset += 64) {
+          sum += page->GetData()[offset];
+        }
+        EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+      }
+      // The first scan warms the page cache and the mapping.
+      if (scan > 0) {
+        elapsed += std::chrono::steady_clock::now() - start;
+      }
+      EXPECT_EQ(static_cast<int64_t>(num_pages / 128) * (127 * 128 / 2) * (PAGE_SIZE / 64), sum);
+    }
+    std::cout << (page_io_mode == PageIOMode::BUFFERED ? "copying" : "mapped") << " scan: "
+              << static_cast<int64_t>(num_pages * num_scans / elapsed.count()) << " pages per second" << std::endl;
+
+    disk_manager->ShutDown();
+    delete bpm;
+    delete disk_manager;
+  }
+  remove(db_name.c_str());
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, ConcurrentMissTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 16;
+  const int num_pages = 64;
+  const int num_threads = 8;
+  const int num_ops = 5000;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+
+  page_id_t page_id_temp;
+  for (int i = 0; i < num_pages; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "Page %d", page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+
+  // Scenario: Threads keep missing on the same pages, so loads and write-backs of a frame overlap with fetches of the
+  // page it is evicting or loading, and with background flushes. Every fetch must see the page's own data.
+  bpm->RunBackgroundFlushThread(buffer_pool_size / 2);
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; ++tid) {
+    threads.emplace_back([bpm, tid, num_pages, num_ops] {
+      std::default_random_engine rng(tid);
+      std::uniform_int_distribution<page_id_t> uniform_dist(0, num_pages - 1);
+      for (int i = 0; i < num_ops; ++i) {
+        page_id_t page_id = uniform_dist(rng);
+        auto *page = bpm->FetchPage(page_id);
+        ASSERT_NE(nullptr, page);
+        EXPECT_EQ(page_id, page->GetPageId());
+        EXPECT_EQ(0, strcmp(page->GetData(), ("Page " + std::to_string(page_id)).c_str()));
+        EXPECT_EQ(true, bpm->UnpinPage(page_id, i % 2 == 0));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  bpm->StopBackgroundFlushThread();
+
+  // Scenario: No pin was leaked by the concurrent fetches.
+  for (page_id_t i = 0; i < num_pages; ++i) {
+    auto *page = bpm->FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(1, page->GetPinCount());
+    EXPECT_EQ(true, bpm->UnpinPage(i, false));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, ContendedHotPagesTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 32;
+  const int num_hot_pages = 8;
+  const int num_scan_pages = 256;
+  const int num_threads = 4;
+
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager, nullptr, BufferPoolManager::ReplacerType::LRU_K);
+  page_id_t page_id_temp;
+  for (int i = 0; i < num_hot_pages + num_scan_pages; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+
+  // Scenario: Threads keep hitting the hot pages while scans evict frames, so that their unpins often find the latch
+  // taken. Their accesses are recorded all the same, and the hot pages survive the scans.
+  std::atomic<bool> scanning{true};
+  std::atomic<int> num_started{0};
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; ++tid) {
+    threads.emplace_back([&bpm, &scanning, &num_started, tid] {
+      for (int i = tid; scanning; ++i) {
+        page_id_t page_id = i % num_hot_pages;
+        auto *page = bpm->FetchPage(page_id);
+        ASSERT_NE(nullptr, page);
+        EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+        if (i == tid + 2 * num_hot_pages) {
+          num_started++;
+        }
+      }
+    });
+  }
+  while (num_started < num_threads) {
+    std::this_thread::yield();
+  }
+  for (int scan = 0; scan < 3; ++scan) {
+    for (page_id_t page_id = num_hot_pages; page_id < num_hot_pages + num_scan_pages; ++page_id) {
+      ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+      EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+      std::this_thread::yield();
+    }
+  }
+  scanning = false;
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  for (page_id_t page_id = 0; page_id < num_hot_pages; ++page_id) {
+    EXPECT_NE(nullptr, bpm->TryFetchPage(page_id));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+
+  disk_manager->ShutDown();
+  remove(db_name.c_str());
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, ResizeTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 4;
+  const size_t num_instances = 2;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, num_instances, disk_manager);
+
+  // Scenario: Once every frame is pinned, growing the pool makes new frames available right away.
+  std::vector<page_id_t> page_ids;
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "Page %d", page_id_temp);
+    page_ids.push_back(page_id_temp);
+  }
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+  bpm->Resize(2 * buffer_pool_size);
+  EXPECT_EQ(2 * buffer_pool_size, bpm->GetPoolSize());
+  EXPECT_EQ(2 * buffer_pool_size, bpm->GetPages().size());
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "Page %d", page_id_temp);
+    page_ids.push_back(page_id_temp);
+  }
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+
+  // Scenario: Shrinking the pool writes back the dirty pages of the removed frames, which can be read back after.
+  for (page_id_t page_id : page_ids) {
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+  }
+  bpm->Resize(buffer_pool_size);
+  EXPECT_EQ(buffer_pool_size, bpm->GetPoolSize());
+  EXPECT_EQ(buffer_pool_size, bpm->GetPages().size());
+  for (page_id_t page_id : page_ids) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(0, strcmp(page->GetData(), ("Page " + std::to_string(page_id)).c_str()));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+
+  // Scenario: The pool keeps serving fetches while it is grown and shrunk, and every fetch sees the page's own data.
+  const int num_threads = 4;
+  const int num_ops = 2000;
+  std::atomic<bool> done{false};
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; ++tid) {
+    threads.emplace_back([bpm, tid, &page_ids, num_ops] {
+      std::default_random_engine rng(tid);
+      std::uniform_int_distribution<size_t> uniform_dist(0, page_ids.size() - 1);
+      for (int i = 0; i < num_ops; ++i) {
+        page_id_t page_id = page_ids[uniform_dist(rng)];
+        auto *page = bpm->FetchPage(page_id);
+        if (page == nullptr) {
+          // Every frame of the page's instance is pinned by the other threads.
+          continue;
+        }
+        EXPECT_EQ(page_id, page->GetPageId());
+        EXPECT_EQ(0, strcmp(page->GetData(), ("Page " + std::to_string(page_id)).c_str()));
+        EXPECT_EQ(true, bpm->UnpinPage(page_id, i % 2 == 0));
+      }
+    });
+  }
+  std::thread resizer([bpm, &done, buffer_pool_size] {
+    size_t pool_size = buffer_pool_size;
+    while (!done) {
+      pool_size = pool_size == buffer_pool_size ? 4 * buffer_pool_size : buffer_pool_size;
+      bpm->Resize(pool_size);
+    }
+  });
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  done = true;
+  resizer.join();
+
+  // Scenario: No pin was leaked, and no page was lost while frames were drained.
+  for (page_id_t page_id : page_ids) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(1, page->GetPinCount());
+    EXPECT_EQ(0, strcmp(page->GetData(), ("Page " + std::to_string(page_id)).c_str()));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, StatsTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 4;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+
+  // Scenario: Fill the pool, then fail to create a page because every frame is pinned.
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  }
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+  BufferPoolStats stats = bpm->GetStats();
+  EXPECT_EQ(4U, stats.new_pages_);
+  EXPECT_EQ(1U, stats.all_pinned_failures_);
+  EXPECT_EQ(0U, stats.evictions_);
+
+  // Scenario: A hit pins the page again, and the dump shows every pin.
+  ASSERT_NE(nullptr, bpm->FetchPage(0));
+  std::vector<std::pair<page_id_t, int>> pinned_pages = {{0, 2}, {1, 1}, {2, 1}, {3, 1}};
+  EXPECT_EQ(pinned_pages, bpm->GetPinnedPages());
+  EXPECT_EQ("page 0: 2 pins\npage 1: 1 pins\npage 2: 1 pins\npage 3: 1 pins\n", bpm->DumpPinnedPages());
+  EXPECT_EQ(true, bpm->UnpinPage(0, true));
+  EXPECT_EQ(true, bpm->UnpinPage(0, true));
+  for (page_id_t page_id = 1; page_id < 4; ++page_id) {
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+  EXPECT_EQ(true, bpm->GetPinnedPages().empty());
+
+  // Scenario: A new page evicts dirty page 0, fetching page 0 again misses and evicts page 1, dirty since it is new.
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+  ASSERT_NE(nullptr, bpm->FetchPage(0));
+  EXPECT_EQ(true, bpm->UnpinPage(0, false));
+  BufferAccessStrategy strategy(2);
+  ASSERT_NE(nullptr, bpm->FetchPage(0, &strategy));
+  EXPECT_EQ(true, bpm->UnpinPage(0, false));
+
+  stats = bpm->GetStats();
+  EXPECT_EQ(1U, stats.hits_[static_cast<size_t>(AccessType::SHARED)]);
+  EXPECT_EQ(1U, stats.hits_[static_cast<size_t>(AccessType::STRATEGY)]);
+  EXPECT_EQ(1U, stats.misses_[static_cast<size_t>(AccessType::SHARED)]);
+  EXPECT_EQ(0U, stats.misses_[static_cast<size_t>(AccessType::STRATEGY)]);
+  EXPECT_DOUBLE_EQ(2.0 / 3.0, stats.GetHitRatio());
+  EXPECT_EQ(5U, stats.new_pages_);
+  EXPECT_EQ(2U, stats.evictions_);
+  EXPECT_EQ(2U, stats.dirty_write_backs_);
+  EXPECT_EQ(stats.ToString(), bpm->GetInstanceStats(0).ToString());
+
+  // Scenario: A reset starts the counters over.
+  bpm->ResetStats();
+  stats = bpm->GetStats();
+  EXPECT_EQ(0U, stats.GetHits() + stats.GetMisses() + stats.new_pages_ + stats.evictions_);
+  EXPECT_EQ(0U, stats.GetHitRatio());
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
 }  // namespace bustub
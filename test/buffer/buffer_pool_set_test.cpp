@@ -0,0 +1,96 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_set_test.cpp
+//
+// Identification: test/buffer/buffer_pool_set_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/buffer_pool_set.h"
+
+#include <cstdio>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(BufferPoolSetTest, SampleTest) {
+  const std::string db_name = "test.db";
+  const size_t heap_pool_size = 10;
+  const size_t temp_pool_size = 2;
+  const size_t num_temp_pages = 50;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *buffer_pools = new BufferPoolSet(disk_manager, nullptr);
+
+  // Scenario: Every page class uses the first pool until it is routed elsewhere.
+  BufferPoolManager *heap_pool = buffer_pools->AddPool("heap", heap_pool_size);
+  EXPECT_EQ(heap_pool, buffer_pools->GetPool(PageClass::TEMP));
+  BufferPoolManager *temp_pool =
+      buffer_pools->AddPool("temp", temp_pool_size, 1, BufferPoolManager::ReplacerType::CLOCK);
+  buffer_pools->Route(PageClass::TEMP, "temp");
+  EXPECT_EQ(heap_pool, buffer_pools->GetPool(PageClass::HEAP));
+  EXPECT_EQ(heap_pool, buffer_pools->GetPool(PageClass::INDEX));
+  EXPECT_EQ(temp_pool, buffer_pools->GetPool(PageClass::TEMP));
+  EXPECT_EQ(temp_pool, buffer_pools->GetPool("temp"));
+  EXPECT_EQ(nullptr, buffer_pools->GetPool("index"));
+
+  // Scenario: Fill the heap pool with dirty pages.
+  page_id_t page_id_temp;
+  std::vector<page_id_t> heap_pages;
+  for (size_t i = 0; i < heap_pool_size; ++i) {
+    auto *page = buffer_pools->GetPool(PageClass::HEAP)->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    heap_pages.push_back(page_id_temp);
+    EXPECT_EQ(true, heap_pool->UnpinPage(page_id_temp, true));
+  }
+
+  // Scenario: Spilling many more temporary pages than either pool holds only evicts temporary pages.
+  for (size_t i = 0; i < num_temp_pages; ++i) {
+    auto *page = buffer_pools->GetPool(PageClass::TEMP)->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "Temp %d", page_id_temp);
+    EXPECT_EQ(true, temp_pool->UnpinPage(page_id_temp, true));
+  }
+  for (page_id_t page_id : heap_pages) {
+    ASSERT_NE(nullptr, heap_pool->FetchPage(page_id));
+    EXPECT_EQ(true, heap_pool->UnpinPage(page_id, false));
+  }
+
+  // Scenario: Every pool keeps its own statistics.
+  auto stats = buffer_pools->GetStats();
+  ASSERT_EQ(2U, stats.size());
+  EXPECT_EQ("heap", stats[0].first);
+  EXPECT_EQ(heap_pool_size, stats[0].second.new_pages_);
+  EXPECT_EQ(heap_pool_size, stats[0].second.GetHits());
+  EXPECT_EQ(0U, stats[0].second.evictions_);
+  EXPECT_EQ("temp", stats[1].first);
+  EXPECT_EQ(num_temp_pages, stats[1].second.new_pages_);
+  EXPECT_EQ(num_temp_pages - temp_pool_size, stats[1].second.evictions_);
+  EXPECT_EQ(num_temp_pages - temp_pool_size, stats[1].second.dirty_write_backs_);
+
+  // Scenario: Flushing the set writes back the dirty pages of every pool.
+  buffer_pools->FlushAllPages();
+  for (auto [pool, page_id] : {std::make_pair(heap_pool, heap_pages[0]), std::make_pair(temp_pool, page_id_temp)}) {
+    auto *page = pool->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_FALSE(page->IsDirty());
+    EXPECT_EQ(true, pool->UnpinPage(page_id, false));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete buffer_pools;
+  delete disk_manager;
+}
+
+}  // namespace bustub
@@ -0,0 +1,43 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_arena_test.cpp
+//
+// Identification: test/buffer/frame_arena_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdint>
+
+#include "buffer/frame_arena.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(FrameArenaTest, SampleTest) {
+  const size_t num_frames = 1024;
+  FrameArena arena(num_frames);
+
+  // Scenario: Frames are zeroed, page-aligned and laid out back to back.
+  for (size_t i = 0; i < num_frames; ++i) {
+    char *data = arena.GetFrameData(i);
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(data) % PAGE_SIZE);
+    EXPECT_EQ(arena.GetFrameData(0) + i * PAGE_SIZE, data);
+    EXPECT_EQ(0, data[0]);
+    EXPECT_EQ(0, data[PAGE_SIZE - 1]);
+  }
+
+  // Scenario: Writing a frame does not touch its neighbours.
+  arena.GetFrameData(1)[0] = 'a';
+  arena.GetFrameData(1)[PAGE_SIZE - 1] = 'z';
+  EXPECT_EQ(0, arena.GetFrameData(0)[PAGE_SIZE - 1]);
+  EXPECT_EQ('a', arena.GetFrameData(1)[0]);
+  EXPECT_EQ('z', arena.GetFrameData(1)[PAGE_SIZE - 1]);
+  EXPECT_EQ(0, arena.GetFrameData(2)[0]);
+}
+
+}  // namespace bustub
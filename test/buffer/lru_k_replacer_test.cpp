@@ -0,0 +1,175 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lru_k_replacer_test.cpp
+//
+// Identification: test/buffer/lru_k_replacer_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+#include "buffer/lru_k_replacer.h"
+#include "buffer/lru_replacer.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(LRUKReplacerTest, SampleTest) {
+  LRUKReplacer lru_k_replacer(7, 2, 0);
+
+  // Scenario: access frames 1 to 6 once, then access 1 and 2 again.
+  for (frame_id_t i = 1; i <= 6; ++i) {
+    lru_k_replacer.Pin(i);
+    lru_k_replacer.Unpin(i);
+  }
+  lru_k_replacer.Pin(1);
+  lru_k_replacer.Unpin(1);
+  lru_k_replacer.Pin(2);
+  lru_k_replacer.Unpin(2);
+  EXPECT_EQ(6, lru_k_replacer.Size());
+
+  // Scenario: frames with a single reference go first, least recently accessed first.
+  int value;
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(3, value);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(4, value);
+
+  // Scenario: pinned frames are not victimized, unpinning a frame twice has no effect.
+  lru_k_replacer.Pin(5);
+  lru_k_replacer.Unpin(1);
+  EXPECT_EQ(3, lru_k_replacer.Size());
+
+  // Scenario: frame 6 still has a single reference. Frame 1 has the oldest second most recent reference.
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(6, value);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(1, value);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(2, value);
+  EXPECT_FALSE(lru_k_replacer.Victim(&value));
+
+  // Scenario: frame 5 had two references before being pinned, frame 3 starts over after being victimized.
+  lru_k_replacer.Unpin(5);
+  lru_k_replacer.Pin(3);
+  lru_k_replacer.Unpin(3);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(3, value);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(5, value);
+}
+
+// NOLINTNEXTLINE
+TEST(LRUKReplacerTest, CorrelatedReferenceTest) {
+  LRUKReplacer lru_k_replacer(3, 2, 2);
+
+  // Scenario: frame 0 is accessed three times in a row, which is a single reference. Frame 1 is accessed twice, far
+  // enough apart for both accesses to count.
+  lru_k_replacer.Pin(1);
+  lru_k_replacer.Unpin(1);
+  lru_k_replacer.Pin(2);
+  lru_k_replacer.Unpin(2);
+  lru_k_replacer.Pin(2);
+  lru_k_replacer.Unpin(2);
+  lru_k_replacer.Pin(1);
+  lru_k_replacer.Unpin(1);
+  for (int i = 0; i < 3; ++i) {
+    lru_k_replacer.Pin(0);
+    lru_k_replacer.Unpin(0);
+  }
+
+  // Frame 2 was only accessed twice in a row, so 0 and 2 both have a single reference, and 2 was accessed last.
+  int value;
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(2, value);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(0, value);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(1, value);
+}
+
+/**
+ * Simulates a buffer pool driven by the given replacer under a mix of index point lookups and a sequential scan, and
+ * returns the hit rate of the index pages.
+ */
+static double IndexHitRate(Replacer *replacer, size_t pool_size) {
+  const int num_lookups = 20000;
+  const page_id_t num_leaves = 27;
+  const page_id_t num_internals = 4;
+  const int scan_pages_per_lookup = 8;
+  const int accesses_per_scan_page = 4;
+
+  std::unordered_map<page_id_t, frame_id_t> page_table;
+  std::vector<page_id_t> frames(pool_size, INVALID_PAGE_ID);
+  frame_id_t next_free_frame = 0;
+  auto access = [&](page_id_t page_id) {
+    auto it = page_table.find(page_id);
+    bool hit = it != page_table.end();
+    frame_id_t frame_id;
+    if (hit) {
+      frame_id = it->second;
+    } else {
+      if (next_free_frame < static_cast<frame_id_t>(pool_size)) {
+        frame_id = next_free_frame++;
+      } else {
+        EXPECT_TRUE(replacer->Victim(&frame_id));
+        page_table.erase(frames[frame_id]);
+      }
+      frames[frame_id] = page_id;
+      page_table[page_id] = frame_id;
+    }
+    replacer->Pin(frame_id);
+    replacer->Unpin(frame_id);
+    return hit;
+  };
+
+  // Index pages are [0, 32), root first, then the internal pages, then the leaves. Scan pages come after them.
+  std::default_random_engine rng(15445);
+  std::uniform_int_distribution<page_id_t> leaf_dist(0, num_leaves - 1);
+  page_id_t next_scan_page = 1 + num_internals + num_leaves;
+  int index_accesses = 0;
+  int index_hits = 0;
+  for (int i = 0; i < num_lookups; ++i) {
+    page_id_t leaf = leaf_dist(rng);
+    bool measure = i >= num_lookups / 10;  // warm up first
+    for (page_id_t page_id : {0, 1 + leaf % num_internals, 1 + num_internals + leaf}) {
+      bool hit = access(page_id);
+      if (measure) {
+        index_accesses++;
+        index_hits += hit ? 1 : 0;
+      }
+    }
+    for (int j = 0; j < scan_pages_per_lookup; ++j) {
+      page_id_t scan_page = next_scan_page++;
+      for (int k = 0; k < accesses_per_scan_page; ++k) {
+        access(scan_page);
+      }
+    }
+  }
+  return static_cast<double>(index_hits) / index_accesses;
+}
+
+// NOLINTNEXTLINE
+TEST(LRUKReplacerTest, ScanResistanceTest) {
+  const size_t pool_size = 64;
+
+  LRUReplacer lru_replacer(pool_size);
+  LRUKReplacer lru_k_replacer(pool_size);
+  double lru_hit_rate = IndexHitRate(&lru_replacer, pool_size);
+  double lru_k_hit_rate = IndexHitRate(&lru_k_replacer, pool_size);
+
+  // Scenario: the scan flushes the index leaves out of an LRU pool, while LRU-K keeps the whole index resident.
+  EXPECT_GT(lru_k_hit_rate, 0.99);
+  EXPECT_GT(lru_k_hit_rate, lru_hit_rate);
+}
+
+}  // namespace bustub
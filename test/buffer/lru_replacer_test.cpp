@@ -10,7 +10,10 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <chrono>  // NOLINT
 #include <cstdio>
+#include <iostream>
+#include <random>
 #include <thread>  // NOLINT
 #include <vector>
 
@@ -59,4 +62,43 @@ TEST(LRUReplacerTest, SampleTest) {
   EXPECT_EQ(4, value);
 }
 
+// A benchmark, run with --gtest_also_run_disabled_tests.
+TEST(LRUReplacerTest, DISABLED_PinUnpinCostTest) {
+  const int num_ops = 1000000;
+
+  // Pin/Unpin cost should not depend on the number of frames.
+  for (size_t num_frames : {1UL << 10, 1UL << 16, 1UL << 20}) {
+    LRUReplacer lru_replacer(num_frames);
+    for (size_t i = 0; i < num_frames; ++i) {
+      lru_replacer.Unpin(i);
+    }
+    EXPECT_EQ(num_frames, lru_replacer.Size());
+
+    std::default_random_engine rng(static_cast<unsigned>(num_frames));
+    std::uniform_int_distribution<frame_id_t> uniform_dist(0, num_frames - 1);
+    std::vector<frame_id_t> frames(num_ops);
+    for (auto &frame : frames) {
+      frame = uniform_dist(rng);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for (frame_id_t frame : frames) {
+      lru_replacer.Pin(frame);
+      lru_replacer.Unpin(frame);
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << num_frames << " frames: " << elapsed.count() / num_ops << " ns per pin/unpin pair" << std::endl;
+
+    // Scenario: every frame is still in the replacer exactly once.
+    EXPECT_EQ(num_frames, lru_replacer.Size());
+    std::vector<bool> seen(num_frames);
+    frame_id_t value;
+    while (lru_replacer.Victim(&value)) {
+      EXPECT_FALSE(seen[value]);
+      seen[value] = true;
+    }
+    EXPECT_EQ(0, lru_replacer.Size());
+  }
+}
+
 }  // namespace bustub
@@ -0,0 +1,111 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_table_test.cpp
+//
+// Identification: test/buffer/page_table_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <atomic>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/page_table.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(PageTableTest, SampleTest) {
+  const int num_pages = 1000;
+  std::vector<int> frames(num_pages);
+  PageTable<int> page_table(8);
+
+  // Scenario: The table grows past its initial capacity and finds every page.
+  for (int i = 0; i < num_pages; ++i) {
+    page_table.Insert(i, &frames[i]);
+  }
+  EXPECT_EQ(static_cast<size_t>(num_pages), page_table.Size());
+  for (int i = 0; i < num_pages; ++i) {
+    EXPECT_EQ(&frames[i], page_table.Find(i));
+  }
+  EXPECT_EQ(nullptr, page_table.Find(num_pages));
+
+  // Scenario: Mapping a page again replaces its frame.
+  page_table.Insert(0, &frames[1]);
+  EXPECT_EQ(static_cast<size_t>(num_pages), page_table.Size());
+  EXPECT_EQ(&frames[1], page_table.Find(0));
+
+  // Scenario: Erasing pages keeps the pages of their clusters reachable.
+  for (int i = 0; i < num_pages; i += 2) {
+    EXPECT_EQ(true, page_table.Erase(i));
+  }
+  EXPECT_EQ(false, page_table.Erase(0));
+  EXPECT_EQ(static_cast<size_t>(num_pages / 2), page_table.Size());
+  for (int i = 0; i < num_pages; ++i) {
+    EXPECT_EQ(i % 2 == 0 ? nullptr : &frames[i], page_table.Find(i));
+  }
+
+  // Scenario: ForEach visits every mapping once.
+  int num_mappings = 0;
+  page_table.ForEach([&num_mappings, &frames](page_id_t page_id, int *frame) {
+    EXPECT_EQ(&frames[page_id], frame);
+    num_mappings++;
+  });
+  EXPECT_EQ(num_pages / 2, num_mappings);
+}
+
+// NOLINTNEXTLINE
+TEST(PageTableTest, ConcurrentFindTest) {
+  const int num_pages = 256;
+  const int num_readers = 4;
+  std::vector<int> frames(num_pages);
+  PageTable<int> page_table(16);
+  // Odd pages are always mapped, even pages come and go.
+  for (int i = 1; i < num_pages; i += 2) {
+    page_table.Insert(i, &frames[i]);
+  }
+
+  // Scenario: Readers racing with a writer only get frames that are in the table. A page that stays mapped can only be
+  // missed, or mistaken for another, while the writer moves it, so most lookups find it.
+  std::atomic<bool> done{false};
+  std::vector<std::thread> readers;
+  for (int tid = 0; tid < num_readers; ++tid) {
+    readers.emplace_back([&page_table, &frames, &done, num_pages] {
+      int64_t num_found = 0;
+      int64_t num_lookups = 0;
+      while (!done) {
+        for (int i = 0; i < num_pages; ++i) {
+          int *frame = page_table.Find(i);
+          EXPECT_TRUE(frame == nullptr || (frame >= &frames.front() && frame <= &frames.back()));
+          if (i % 2 == 1) {
+            num_lookups++;
+            num_found += frame == &frames[i] ? 1 : 0;
+          }
+        }
+      }
+      EXPECT_GE(2 * num_found, num_lookups);
+    });
+  }
+  for (int round = 0; round < 200; ++round) {
+    for (int i = 0; i < num_pages; i += 2) {
+      page_table.Insert(i, &frames[i]);
+    }
+    for (int i = 0; i < num_pages; i += 2) {
+      page_table.Erase(i);
+    }
+  }
+  done = true;
+  for (auto &reader : readers) {
+    reader.join();
+  }
+  for (int i = 1; i < num_pages; i += 2) {
+    EXPECT_EQ(&frames[i], page_table.Find(i));
+  }
+}
+
+}  // namespace bustub
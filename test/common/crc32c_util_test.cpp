@@ -0,0 +1,47 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// crc32c_util_test.cpp
+//
+// Identification: test/common/crc32c_util_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <string>
+
+#include "common/util/crc32c_util.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+TEST(Crc32cUtilTest, KnownValuesTest) {
+  // The check value of the CRC32C catalogue, and the test vectors of RFC 3720.
+  EXPECT_EQ(0xE3069283, Crc32cUtil::Crc32c("123456789", 9));
+  EXPECT_EQ(0, Crc32cUtil::Crc32c("", 0));
+  std::string zeroes(32, '\0');
+  EXPECT_EQ(0x8A9136AA, Crc32cUtil::Crc32c(zeroes.data(), zeroes.size()));
+  std::string ones(32, '\xff');
+  EXPECT_EQ(0x62A8AB43, Crc32cUtil::Crc32c(ones.data(), ones.size()));
+  std::string ascending;
+  for (int i = 0; i < 32; ++i) {
+    ascending.push_back(static_cast<char>(i));
+  }
+  EXPECT_EQ(0x46DD794E, Crc32cUtil::Crc32c(ascending.data(), ascending.size()));
+
+  // Scenario: The result does not depend on the alignment of the data.
+  std::string shifted = "x" + ascending;
+  EXPECT_EQ(0x46DD794E, Crc32cUtil::Crc32c(shifted.data() + 1, ascending.size()));
+
+  // Scenario: Data long enough to be checksummed in several streams at once, with and without a remainder.
+  std::string page;
+  for (int i = 0; i < 4096; ++i) {
+    page.push_back(static_cast<char>(i % 256));
+  }
+  EXPECT_EQ(0x9C71FE32, Crc32cUtil::Crc32c(page.data(), page.size()));
+  EXPECT_EQ(0x1A318E30, Crc32cUtil::Crc32c(page.data(), 1000));
+}
+
+}  // namespace bustub
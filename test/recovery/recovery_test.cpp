@@ -251,13 +251,11 @@ TEST_F(RecoveryTest, DISABLED_CheckpointTest) {
   bustub_instance->checkpoint_manager_->BeginCheckpoint();
   bustub_instance->checkpoint_manager_->EndCheckpoint();
 
-  Page *pages = bustub_instance->buffer_pool_manager_->GetPages();
-  size_t pool_size = bustub_instance->buffer_pool_manager_->GetPoolSize();
+  std::vector<Page *> pages = bustub_instance->buffer_pool_manager_->GetPages();
 
   // make sure that all pages in the buffer pool are marked as non-dirty
   bool all_pages_clean = true;
-  for (size_t i = 0; i < pool_size; i++) {
-    Page *page = &pages[i];
+  for (Page *page : pages) {
     page_id_t page_id = page->GetPageId();
 
     if (page_id != INVALID_PAGE_ID && page->IsDirty()) {
@@ -271,8 +269,7 @@ TEST_F(RecoveryTest, DISABLED_CheckpointTest) {
   // data on disk. ensure they match after the checkpoint
   bool all_pages_match = true;
   auto *disk_data = new char[PAGE_SIZE];
-  for (size_t i = 0; i < pool_size; i++) {
-    Page *page = &pages[i];
+  for (Page *page : pages) {
     page_id_t page_id = page->GetPageId();
 
     if (page_id != INVALID_PAGE_ID) {
@@ -294,8 +291,7 @@ TEST_F(RecoveryTest, DISABLED_CheckpointTest) {
 
   // verify log was flushed and each page's LSN <= persistent lsn
   bool all_pages_lte = true;
-  for (size_t i = 0; i < pool_size; i++) {
-    Page *page = &pages[i];
+  for (Page *page : pages) {
     page_id_t page_id = page->GetPageId();
 
     if (page_id != INVALID_PAGE_ID && page->GetLSN() > persistent_lsn) {
@@ -10,11 +10,19 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <sys/stat.h>
+#include <cstdint>
+#include <cstdio>
 #include <cstring>
+#include <future>  // NOLINT
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
 
 #include "common/exception.h"
 #include "gtest/gtest.h"
 #include "storage/disk/disk_manager.h"
+#include "storage/disk/extent_allocator.h"
 
 namespace bustub {
 
@@ -24,12 +32,16 @@ class DiskManagerTest : public ::testing::Test {
   void SetUp() override {
     remove("test.db");
     remove("test.log");
+    remove("test.bitmap");
+    remove("test.checksum");
   }
 
   // This function is called after every test.
   void TearDown() override {
     remove("test.db");
     remove("test.log");
+    remove("test.bitmap");
+    remove("test.checksum");
   };
 };
 
@@ -72,6 +84,502 @@ TEST_F(DiskManagerTest, ReadWriteLogTest) {
   dm.ShutDown();
 }
 
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, SyncTest) {
+  char data[PAGE_SIZE] = {0};
+  char buf[PAGE_SIZE] = {0};
+  std::string db_file("test.db");
+  auto dm = DiskManager(db_file);
+  std::strncpy(data, "A test string.", sizeof(data));
+
+  // Scenario: Writes do not sync, syncs are explicit and counted apart from the writes and the log flushes.
+  dm.WritePage(0, data);
+  dm.WriteLog(data, sizeof(data));
+  EXPECT_EQ(1, dm.GetNumWrites());
+  EXPECT_EQ(1, dm.GetNumFlushes());
+  EXPECT_EQ(0, dm.GetNumSyncs());
+  dm.Sync();
+  dm.SyncLog();
+  EXPECT_EQ(2, dm.GetNumSyncs());
+  EXPECT_EQ(1, dm.GetNumWrites());
+  EXPECT_EQ(1, dm.GetNumFlushes());
+
+  dm.ReadPage(0, buf);
+  EXPECT_EQ(0, std::memcmp(buf, data, sizeof(buf)));
+  dm.ReadLog(buf, sizeof(data), 0);
+  EXPECT_EQ(0, std::memcmp(buf, data, sizeof(data)));
+
+  // Scenario: Syncing after shutdown does nothing.
+  dm.ShutDown();
+  dm.Sync();
+  dm.SyncLog();
+  EXPECT_EQ(2, dm.GetNumSyncs());
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, ConcurrentReadWritePageTest) {
+  const int num_threads = 8;
+  const int num_pages_per_thread = 16;
+  const int num_rounds = 50;
+  std::string db_file("test.db");
+  auto dm = DiskManager(db_file);
+
+  // Scenario: Every thread rewrites and reads back its own pages, interleaved with the pages of the other threads.
+  // A page must always read back as the version its thread last wrote.
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; ++tid) {
+    threads.emplace_back([&dm, tid] {
+      char data[PAGE_SIZE];
+      char buf[PAGE_SIZE];
+      for (int round = 0; round < num_rounds; ++round) {
+        for (int i = 0; i < num_pages_per_thread; ++i) {
+          page_id_t page_id = i * num_threads + tid;
+          std::memset(data, 'a' + (round + page_id) % 26, sizeof(data));
+          snprintf(data, sizeof(data), "Page %d round %d", page_id, round);
+          dm.WritePage(page_id, data);
+          dm.ReadPage(page_id, buf);
+          EXPECT_EQ(0, std::memcmp(buf, data, sizeof(buf))) << "page " << page_id << " round " << round;
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(num_threads * num_pages_per_thread * num_rounds, dm.GetNumWrites());
+
+  // Scenario: Every page holds its last version.
+  char buf[PAGE_SIZE];
+  for (page_id_t page_id = 0; page_id < num_threads * num_pages_per_thread; ++page_id) {
+    dm.ReadPage(page_id, buf);
+    EXPECT_EQ(0, strcmp(buf, ("Page " + std::to_string(page_id) + " round " + std::to_string(num_rounds - 1)).c_str()));
+  }
+
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, WritePagesTest) {
+  const page_id_t num_pages = 1500;
+  std::string db_file("test.db");
+  char buf[PAGE_SIZE];
+
+  for (auto page_io_mode : {PageIOMode::BUFFERED, PageIOMode::DIRECT}) {
+    auto dm = DiskManager(db_file, page_io_mode);
+    // One more page, to align the pages on page boundaries as direct I/O needs.
+    std::vector<char> aligned_data((num_pages + 1) * PAGE_SIZE);
+    char *data = aligned_data.data() + (PAGE_SIZE - reinterpret_cast<uintptr_t>(aligned_data.data()) % PAGE_SIZE);
+    for (page_id_t page_id = 0; page_id < num_pages; ++page_id) {
+      std::memset(data + page_id * PAGE_SIZE, 'a' + page_id % 26, PAGE_SIZE);
+      snprintf(data + page_id * PAGE_SIZE, PAGE_SIZE, "Page %d", page_id);
+    }
+
+    // Scenario: A run longer than IOV_MAX, out of order, with a gap, a page listed twice and an unaligned page.
+    std::vector<PageWrite> pages;
+    for (page_id_t page_id = num_pages - 1; page_id >= 0; --page_id) {
+      if (page_id != 1100 && page_id != 1200) {
+        pages.push_back({page_id, data + page_id * PAGE_SIZE});
+      }
+    }
+    pages.push_back({3, data + 7 * PAGE_SIZE});
+    pages.push_back({3, data + 3 * PAGE_SIZE});
+    std::vector<char> unaligned(PAGE_SIZE + 1);
+    std::memcpy(unaligned.data() + 1, data + 1200 * PAGE_SIZE, PAGE_SIZE);
+    pages.push_back({1200, unaligned.data() + 1});
+    dm.WritePages(pages);
+    EXPECT_EQ(num_pages - 1, dm.GetNumWrites());
+
+    for (page_id_t page_id = 0; page_id < num_pages; ++page_id) {
+      EXPECT_TRUE(dm.ReadPage(page_id, buf));
+      if (page_id == 1100) {
+        EXPECT_EQ(std::string(PAGE_SIZE, '\0'), std::string(buf, PAGE_SIZE));
+      } else {
+        EXPECT_EQ(0, std::memcmp(buf, data + page_id * PAGE_SIZE, PAGE_SIZE)) << "page " << page_id;
+      }
+    }
+    EXPECT_EQ(0, dm.GetNumChecksumFailures());
+
+    dm.ShutDown();
+    remove(db_file.c_str());
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, AsyncReadWritePageTest) {
+  const int num_pages = 4 * ASYNC_IO_QUEUE_DEPTH;
+  std::string db_file("test.db");
+
+  for (auto backend : {AsyncIOBackend::IO_URING, AsyncIOBackend::THREAD_POOL}) {
+    auto dm = DiskManager(db_file, PageIOMode::BUFFERED, backend);
+    if (backend == AsyncIOBackend::THREAD_POOL) {
+      EXPECT_EQ(AsyncIOBackend::THREAD_POOL, dm.GetAsyncIOBackend());
+    }
+    std::vector<std::vector<char>> pages(num_pages, std::vector<char>(PAGE_SIZE));
+    std::vector<std::future<bool>> done;
+
+    // Scenario: More writes than the queue depth are in flight, then every page reads back as written.
+    for (page_id_t page_id = 0; page_id < num_pages; ++page_id) {
+      std::memset(pages[page_id].data(), 'a' + page_id % 26, PAGE_SIZE);
+      snprintf(pages[page_id].data(), PAGE_SIZE, "Page %d", page_id);
+      done.push_back(dm.WritePageAsync(page_id, pages[page_id].data()));
+    }
+    for (auto &future : done) {
+      EXPECT_TRUE(future.get());
+    }
+    EXPECT_EQ(num_pages, dm.GetNumWrites());
+    done.clear();
+
+    std::vector<std::vector<char>> bufs(num_pages + 1, std::vector<char>(PAGE_SIZE, 'x'));
+    for (page_id_t page_id = 0; page_id <= num_pages; ++page_id) {
+      done.push_back(dm.ReadPageAsync(page_id, bufs[page_id].data()));
+    }
+    for (auto &future : done) {
+      EXPECT_TRUE(future.get());
+    }
+    for (page_id_t page_id = 0; page_id < num_pages; ++page_id) {
+      EXPECT_EQ(0, std::memcmp(bufs[page_id].data(), pages[page_id].data(), PAGE_SIZE)) << "page " << page_id;
+    }
+
+    // Scenario: A page past the end of the file reads as zeroes.
+    EXPECT_EQ(std::vector<char>(PAGE_SIZE, 0), bufs[num_pages]);
+
+    dm.ShutDown();
+    remove(db_file.c_str());
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, DirectReadWritePageTest) {
+  std::string db_file("test.db");
+  auto dm = DiskManager(db_file, PageIOMode::DIRECT);
+  alignas(PAGE_SIZE) char aligned_data[PAGE_SIZE];
+  alignas(PAGE_SIZE) char aligned_buf[PAGE_SIZE];
+  // one byte off the alignment direct I/O needs
+  alignas(PAGE_SIZE) char unaligned_storage[PAGE_SIZE * 2];
+  char *unaligned_buf = unaligned_storage + 1;
+
+  // Scenario: Aligned and unaligned buffers read and write pages alike, synchronously and asynchronously.
+  std::memset(aligned_data, 'd', sizeof(aligned_data));
+  std::strncpy(aligned_data, "A direct test string.", sizeof(aligned_data));
+  dm.WritePage(0, aligned_data);
+  dm.WritePageAsync(1, aligned_data).wait();
+  std::memcpy(unaligned_buf, aligned_data, PAGE_SIZE);
+  dm.WritePage(2, unaligned_buf);
+  dm.WritePageAsync(3, unaligned_buf).wait();
+  EXPECT_EQ(4, dm.GetNumWrites());
+  for (page_id_t page_id = 0; page_id < 4; ++page_id) {
+    std::memset(aligned_buf, 0, sizeof(aligned_buf));
+    dm.ReadPage(page_id, aligned_buf);
+    EXPECT_EQ(0, std::memcmp(aligned_buf, aligned_data, PAGE_SIZE)) << "page " << page_id;
+    std::memset(unaligned_buf, 0, PAGE_SIZE);
+    dm.ReadPageAsync(page_id, unaligned_buf).wait();
+    EXPECT_EQ(0, std::memcmp(unaligned_buf, aligned_data, PAGE_SIZE)) << "page " << page_id;
+  }
+
+  // Scenario: A page past the end of the file reads as zeroes.
+  dm.ReadPage(4, unaligned_buf);
+  EXPECT_EQ(std::string(PAGE_SIZE, '\0'), std::string(unaligned_buf, PAGE_SIZE));
+  dm.ShutDown();
+
+  // Scenario: The pages are in the file as buffered I/O sees it.
+  auto buffered_dm = DiskManager(db_file);
+  buffered_dm.ReadPage(3, aligned_buf);
+  EXPECT_EQ(0, std::memcmp(aligned_buf, aligned_data, PAGE_SIZE));
+  buffered_dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, AllocatePageTest) {
+  char data[PAGE_SIZE] = {0};
+  std::string db_file("test.db");
+  auto dm = DiskManager(db_file);
+
+  // Scenario: Pages are allocated in order, deallocated pages are reused, the closest to the neighbor first.
+  for (page_id_t page_id = 0; page_id < 10; ++page_id) {
+    EXPECT_EQ(page_id, dm.AllocatePage());
+  }
+  dm.DeallocatePage(3);
+  dm.DeallocatePage(7);
+  dm.DeallocatePage(7);
+  dm.DeallocatePage(10);
+  EXPECT_EQ(2, dm.GetNumFreePages());
+  EXPECT_EQ(3, dm.AllocatePage(2));
+  EXPECT_EQ(7, dm.AllocatePage());
+  EXPECT_EQ(10, dm.AllocatePage());
+  EXPECT_EQ(0, dm.GetNumFreePages());
+
+  // Scenario: The allocations survive a restart.
+  dm.DeallocatePage(5);
+  dm.ShutDown();
+  auto restarted_dm = DiskManager(db_file);
+  EXPECT_EQ(1, restarted_dm.GetNumFreePages());
+  EXPECT_EQ(5, restarted_dm.AllocatePage());
+  EXPECT_EQ(11, restarted_dm.AllocatePage());
+  restarted_dm.WritePage(2, data);
+  restarted_dm.ShutDown();
+
+  // Scenario: A database file without a bitmap has all of its pages allocated.
+  remove("test.bitmap");
+  auto legacy_dm = DiskManager(db_file);
+  EXPECT_EQ(3, legacy_dm.AllocatePage());
+  legacy_dm.ShutDown();
+
+  // Scenario: The bitmap of a deleted database file is discarded.
+  remove(db_file.c_str());
+  auto new_dm = DiskManager(db_file);
+  EXPECT_EQ(0, new_dm.AllocatePage());
+  new_dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, AllocateExtentTest) {
+  std::string db_file("test.db");
+  auto dm = DiskManager(db_file);
+  for (page_id_t page_id = 0; page_id < 3; ++page_id) {
+    EXPECT_EQ(page_id, dm.AllocatePage());
+  }
+
+  // Scenario: An extent extends the file, single pages are allocated after it.
+  EXPECT_EQ(3, dm.AllocateExtent(64));
+  EXPECT_EQ(67, dm.AllocatePage());
+
+  // Scenario: An extent reuses the first run of free pages long enough, free pages at the end of the file included.
+  for (page_id_t page_id = 10; page_id < 20; ++page_id) {
+    dm.DeallocatePage(page_id);
+  }
+  dm.DeallocatePage(30);
+  EXPECT_EQ(10, dm.AllocateExtent(8));
+  EXPECT_EQ(68, dm.AllocateExtent(8));
+  for (page_id_t page_id = 70; page_id < 76; ++page_id) {
+    dm.DeallocatePage(page_id);
+  }
+  EXPECT_EQ(70, dm.AllocateExtent(8));
+  EXPECT_EQ(3, dm.GetNumFreePages());
+
+  // Scenario: An extent allocator hands out the pages of its extents in order, and gives back those left over.
+  {
+    ExtentAllocator extent_allocator(&dm, 4);
+    for (page_id_t page_id = 78; page_id < 83; ++page_id) {
+      EXPECT_EQ(page_id, extent_allocator.AllocatePage());
+    }
+  }
+  EXPECT_EQ(6, dm.GetNumFreePages());
+
+  // Scenario: The file space is preallocated, if the file system can, without growing the file.
+  struct stat stat_buf;
+  ASSERT_EQ(0, stat(db_file.c_str(), &stat_buf));
+  EXPECT_EQ(0, stat_buf.st_size);
+  EXPECT_TRUE(stat_buf.st_blocks == 0 || stat_buf.st_blocks * 512 >= PREALLOCATION_SIZE * PAGE_SIZE);
+
+  // Scenario: The extents survive a restart, the pages given back at the end of the file are unallocated again.
+  dm.ShutDown();
+  auto restarted_dm = DiskManager(db_file);
+  EXPECT_EQ(3, restarted_dm.GetNumFreePages());
+  EXPECT_EQ(83, restarted_dm.AllocateExtent(3));
+  EXPECT_EQ(86, restarted_dm.AllocateExtent(3));
+  restarted_dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, LargeFileTest) {
+  const int64_t four_gb = int64_t{4} << 30;
+  // a page past 2 GB, whose offset overflows a signed 32-bit integer, then the last page below 4 GB and the first one
+  // above, whose offset overflows an unsigned one
+  const std::vector<page_id_t> page_ids{(1 << 19) + 1, static_cast<page_id_t>(four_gb / PAGE_SIZE - 1),
+                                        static_cast<page_id_t>(four_gb / PAGE_SIZE)};
+  std::string db_file("test.db");
+  auto dm = DiskManager(db_file);
+  char data[PAGE_SIZE];
+  char buf[PAGE_SIZE];
+
+  // Scenario: Pages beyond 2 GB and 4 GB of a sparse file read back as written, synchronously and asynchronously.
+  for (page_id_t page_id : page_ids) {
+    std::memset(data, 'a' + page_id % 26, sizeof(data));
+    snprintf(data, sizeof(data), "Page %d", page_id);
+    dm.WritePage(page_id, data);
+  }
+  for (page_id_t page_id : page_ids) {
+    std::memset(data, 'a' + page_id % 26, sizeof(data));
+    snprintf(data, sizeof(data), "Page %d", page_id);
+    dm.ReadPage(page_id, buf);
+    EXPECT_EQ(0, std::memcmp(buf, data, sizeof(buf))) << "page " << page_id;
+    std::memset(buf, 0, sizeof(buf));
+    dm.ReadPageAsync(page_id, buf).wait();
+    EXPECT_EQ(0, std::memcmp(buf, data, sizeof(buf))) << "page " << page_id;
+  }
+
+  // Scenario: The file is as large as its last page, and a hole between the pages reads as zeroes.
+  struct stat stat_buf;
+  ASSERT_EQ(0, stat(db_file.c_str(), &stat_buf));
+  EXPECT_EQ((static_cast<int64_t>(page_ids.back()) + 1) * PAGE_SIZE, stat_buf.st_size);
+  dm.ReadPage(page_ids[0] + 1, buf);
+  EXPECT_EQ(std::string(PAGE_SIZE, '\0'), std::string(buf, PAGE_SIZE));
+
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, ChecksumTest) {
+  char data[PAGE_SIZE];
+  char buf[PAGE_SIZE];
+  std::string db_file("test.db");
+  auto dm = DiskManager(db_file);
+  dm.SetChecksumPolicy(ChecksumPolicy::FAIL);
+  std::memset(data, 'a', sizeof(data));
+  std::strncpy(data, "A test string.", sizeof(data));
+  dm.WritePage(0, data);
+  dm.WritePage(1, data);
+  dm.WritePageAsync(2, data).wait();
+
+  // Scenario: Intact pages pass the check, synchronously and asynchronously.
+  EXPECT_TRUE(dm.ReadPage(0, buf));
+  EXPECT_TRUE(dm.ReadPageAsync(2, buf).get());
+  EXPECT_EQ(0, dm.GetNumChecksumFailures());
+
+  // Scenario: A corrupted page fails the read, synchronously and asynchronously.
+  auto corrupt = [&db_file](page_id_t page_id) {
+    FILE *file = fopen(db_file.c_str(), "r+b");
+    ASSERT_NE(nullptr, file);
+    fseek(file, static_cast<int64_t>(page_id) * PAGE_SIZE + 100, SEEK_SET);
+    fputc('z', file);
+    fclose(file);
+  };
+  corrupt(1);
+  corrupt(2);
+  EXPECT_FALSE(dm.ReadPage(1, buf));
+  EXPECT_FALSE(dm.ReadPageAsync(2, buf).get());
+  EXPECT_EQ(2, dm.GetNumChecksumFailures());
+
+  // Scenario: The LOG policy lets the corrupted page through.
+  dm.SetChecksumPolicy(ChecksumPolicy::LOG);
+  EXPECT_TRUE(dm.ReadPage(1, buf));
+  EXPECT_EQ('z', buf[100]);
+  EXPECT_EQ(3, dm.GetNumChecksumFailures());
+
+  // Scenario: The REPAIR policy rebuilds the page and writes it back, or fails the read if it cannot.
+  dm.SetChecksumPolicy(ChecksumPolicy::REPAIR, [&data](page_id_t page_id, char *page_data) {
+    if (page_id != 1) {
+      return false;
+    }
+    std::memcpy(page_data, data, PAGE_SIZE);
+    return true;
+  });
+  EXPECT_TRUE(dm.ReadPage(1, buf));
+  EXPECT_EQ(0, std::memcmp(buf, data, sizeof(buf)));
+  EXPECT_FALSE(dm.ReadPageAsync(2, buf).get());
+  EXPECT_EQ(5, dm.GetNumChecksumFailures());
+  dm.SetChecksumPolicy(ChecksumPolicy::FAIL);
+  EXPECT_TRUE(dm.ReadPage(1, buf));
+  EXPECT_EQ(5, dm.GetNumChecksumFailures());
+
+  // Scenario: The checksums survive a restart, and pages written under the NONE policy are not checked.
+  dm.ShutDown();
+  auto restarted_dm = DiskManager(db_file);
+  restarted_dm.SetChecksumPolicy(ChecksumPolicy::FAIL);
+  EXPECT_TRUE(restarted_dm.ReadPage(0, buf));
+  EXPECT_FALSE(restarted_dm.ReadPage(2, buf));
+  restarted_dm.SetChecksumPolicy(ChecksumPolicy::NONE);
+  EXPECT_TRUE(restarted_dm.ReadPage(2, buf));
+  restarted_dm.WritePage(0, data);
+  restarted_dm.SetChecksumPolicy(ChecksumPolicy::FAIL);
+  corrupt(0);
+  EXPECT_TRUE(restarted_dm.ReadPage(0, buf));
+  EXPECT_EQ(1, restarted_dm.GetNumChecksumFailures());
+  restarted_dm.ShutDown();
+
+  // Scenario: The checksums of a session that did not shut down are kept. A page left as it was before the write in
+  // flight at the crash passes the check, and so does one left as written, while a corrupted page still fails it.
+  char other[PAGE_SIZE];
+  std::memset(other, 'b', sizeof(other));
+  auto overwrite = [&db_file](page_id_t page_id, const char *page_data) {
+    FILE *file = fopen(db_file.c_str(), "r+b");
+    ASSERT_NE(nullptr, file);
+    fseek(file, static_cast<int64_t>(page_id) * PAGE_SIZE, SEEK_SET);
+    fwrite(page_data, 1, PAGE_SIZE, file);
+    fclose(file);
+  };
+  {
+    DiskManager crashed_dm(db_file);
+    crashed_dm.WritePage(1, other);
+  }
+  overwrite(1, data);
+  auto recovered_dm = DiskManager(db_file);
+  recovered_dm.SetChecksumPolicy(ChecksumPolicy::FAIL);
+  EXPECT_TRUE(recovered_dm.ReadPage(1, buf));
+  EXPECT_EQ(0, std::memcmp(buf, data, sizeof(buf)));
+  overwrite(1, other);
+  EXPECT_TRUE(recovered_dm.ReadPage(1, buf));
+  EXPECT_EQ(0, std::memcmp(buf, other, sizeof(buf)));
+  corrupt(1);
+  EXPECT_FALSE(recovered_dm.ReadPage(1, buf));
+  EXPECT_EQ(1, recovered_dm.GetNumChecksumFailures());
+
+  // Scenario: Once a write has completed, the page no longer passes as it was before.
+  recovered_dm.WritePageAsync(1, data).wait();
+  EXPECT_TRUE(recovered_dm.ReadPage(1, buf));
+  overwrite(1, other);
+  EXPECT_FALSE(recovered_dm.ReadPage(1, buf));
+  EXPECT_EQ(2, recovered_dm.GetNumChecksumFailures());
+  recovered_dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, MmapReadOnlyTest) {
+  char data[PAGE_SIZE];
+  char buf[PAGE_SIZE];
+  std::string db_file("test.db");
+
+  // Scenario: A read-only db file must exist.
+  EXPECT_THROW(DiskManager(db_file, PageIOMode::MMAP_READ_ONLY), Exception);
+
+  auto dm = DiskManager(db_file);
+  for (page_id_t page_id = 0; page_id < 3; page_id++) {
+    std::memset(data, 'a' + page_id, sizeof(data));
+    dm.WritePage(page_id, data);
+  }
+  dm.ShutDown();
+  FILE *file = fopen(db_file.c_str(), "r+b");
+  ASSERT_NE(nullptr, file);
+  fseek(file, 2 * PAGE_SIZE + 100, SEEK_SET);
+  fputc('z', file);
+  fclose(file);
+
+  auto read_only_dm = DiskManager(db_file, PageIOMode::MMAP_READ_ONLY);
+  read_only_dm.SetChecksumPolicy(ChecksumPolicy::FAIL);
+  EXPECT_TRUE(read_only_dm.IsReadOnly());
+  EXPECT_EQ(nullptr, dm.GetMappedPage(0));
+
+  // Scenario: Pages are read from the mapping without a copy, and through ReadPage.
+  const char *mapped = read_only_dm.GetMappedPage(1);
+  ASSERT_NE(nullptr, mapped);
+  EXPECT_EQ(read_only_dm.GetMappedPage(0) + PAGE_SIZE, mapped);
+  EXPECT_EQ('b', mapped[0]);
+  EXPECT_EQ('b', mapped[PAGE_SIZE - 1]);
+  EXPECT_TRUE(read_only_dm.ReadPage(1, buf));
+  EXPECT_EQ(0, std::memcmp(buf, mapped, sizeof(buf)));
+
+  // Scenario: Pages past the end of the file and corrupted pages are not handed out, ReadPage applies the policy.
+  EXPECT_EQ(nullptr, read_only_dm.GetMappedPage(3));
+  EXPECT_EQ(nullptr, read_only_dm.GetMappedPage(2));
+  EXPECT_FALSE(read_only_dm.ReadPage(2, buf));
+  read_only_dm.SetChecksumPolicy(ChecksumPolicy::NONE);
+  EXPECT_NE(nullptr, read_only_dm.GetMappedPage(2));
+
+  // Scenario: Nothing is written or allocated, hints are harmless.
+  std::memset(data, 'x', sizeof(data));
+  read_only_dm.WritePage(0, data);
+  read_only_dm.WritePages({{1, data}});
+  EXPECT_FALSE(read_only_dm.WritePageAsync(0, data).get());
+  EXPECT_EQ(INVALID_PAGE_ID, read_only_dm.AllocatePage());
+  read_only_dm.BeginSequentialAccess();
+  read_only_dm.AdviseWillNeed(0, 10);
+  read_only_dm.EndSequentialAccess();
+  EXPECT_EQ('a', read_only_dm.GetMappedPage(0)[0]);
+  EXPECT_EQ('b', read_only_dm.GetMappedPage(1)[0]);
+  EXPECT_EQ(0, read_only_dm.GetNumWrites());
+  read_only_dm.ShutDown();
+}
+
 // NOLINTNEXTLINE
 TEST_F(DiskManagerTest, ThrowBadFileTest) { EXPECT_THROW(DiskManager("dev/null\\/foo/bar/baz/test.db"), Exception); }
 
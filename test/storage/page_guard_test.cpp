@@ -0,0 +1,155 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_guard_test.cpp
+//
+// Identification: test/storage/page_guard_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <utility>
+
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+#include "storage/page/page_guard.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(PageGuardTest, BasicGuardTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 5;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+
+  page_id_t page_id_temp;
+  auto *page0 = bpm->NewPage(&page_id_temp);
+  ASSERT_NE(nullptr, page0);
+
+  // Scenario: A guard holds a pin until it is dropped.
+  {
+    auto guard = bpm->FetchPageBasic(page_id_temp);
+    EXPECT_EQ(true, guard.IsValid());
+    EXPECT_EQ(page_id_temp, guard.PageId());
+    EXPECT_EQ(2, page0->GetPinCount());
+    guard.Drop();
+    EXPECT_EQ(false, guard.IsValid());
+    EXPECT_EQ(1, page0->GetPinCount());
+  }
+
+  // Scenario: Moving a guard moves its pin, the moved-from guard releases nothing.
+  {
+    auto guard = bpm->FetchPageBasic(page_id_temp);
+    BasicPageGuard moved(std::move(guard));
+    EXPECT_EQ(false, guard.IsValid());  // NOLINT
+    EXPECT_EQ(2, page0->GetPinCount());
+    BasicPageGuard assigned;
+    assigned = std::move(moved);
+    EXPECT_EQ(2, page0->GetPinCount());
+
+    // Assigning over a guard releases the pin it held.
+    assigned = bpm->FetchPageBasic(page_id_temp);
+    EXPECT_EQ(2, page0->GetPinCount());
+  }
+  EXPECT_EQ(1, page0->GetPinCount());
+
+  // Scenario: Reading through a guard leaves the page clean, writing through it makes the page dirty. The page is new,
+  // hence dirty, until flushed.
+  EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+  EXPECT_EQ(true, page0->IsDirty());
+  EXPECT_EQ(true, bpm->FlushPage(page_id_temp));
+  {
+    auto guard = bpm->FetchPageBasic(page_id_temp);
+    EXPECT_EQ(0, guard.GetData()[0]);
+  }
+  EXPECT_EQ(false, page0->IsDirty());
+  {
+    auto guard = bpm->FetchPageBasic(page_id_temp);
+    snprintf(guard.GetDataMut(), PAGE_SIZE, "Hello");
+  }
+  EXPECT_EQ(true, page0->IsDirty());
+  EXPECT_EQ(0, page0->GetPinCount());
+
+  // Scenario: A write guard whose change turned out to change nothing unpins the page clean.
+  EXPECT_EQ(true, bpm->FlushPage(page_id_temp));
+  {
+    auto guard = bpm->FetchPageWrite(page_id_temp);
+    EXPECT_EQ(0, strcmp(guard.AsMut<char>(), "Hello"));
+    guard.SetDirty(false);
+  }
+  EXPECT_EQ(false, page0->IsDirty());
+
+  // Scenario: Once every frame is pinned, guards come back empty.
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  }
+  auto empty_guard = bpm->NewPageGuarded(&page_id_temp);
+  EXPECT_EQ(false, empty_guard.IsValid());
+  auto empty_write_guard = empty_guard.UpgradeWrite();
+  EXPECT_EQ(false, empty_write_guard.IsValid());
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(PageGuardTest, ReadWriteGuardTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 5;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+
+  page_id_t page_id_temp;
+  WritePageGuard write_guard = bpm->NewPageGuarded(&page_id_temp).UpgradeWrite();
+  ASSERT_EQ(true, write_guard.IsValid());
+  snprintf(write_guard.GetDataMut(), PAGE_SIZE, "Hello");
+  write_guard.Drop();
+
+  // Scenario: Several read guards can share a page, and release their latch and pin when destroyed.
+  {
+    auto read_guard1 = bpm->FetchPageRead(page_id_temp);
+    auto read_guard2 = bpm->FetchPageRead(page_id_temp);
+    EXPECT_EQ(0, strcmp(read_guard1.GetData(), "Hello"));
+    EXPECT_EQ(0, strcmp(read_guard2.As<char>(), "Hello"));
+    ReadPageGuard moved = std::move(read_guard1);
+    EXPECT_EQ(true, moved.IsValid());
+  }
+
+  // Scenario: A write guard can latch the page again once the read guards are gone.
+  write_guard = bpm->FetchPageWrite(page_id_temp);
+  ASSERT_EQ(true, write_guard.IsValid());
+  EXPECT_EQ(0, strcmp(write_guard.GetData(), "Hello"));
+  write_guard = WritePageGuard();
+
+  // Scenario: Every pin was released, so the page can be evicted and read back.
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    auto guard = bpm->NewPageGuarded(&page_id_temp);
+    EXPECT_EQ(true, guard.IsValid());
+  }
+  {
+    auto read_guard = bpm->FetchPageRead(0);
+    ASSERT_EQ(true, read_guard.IsValid());
+    EXPECT_EQ(0, strcmp(read_guard.GetData(), "Hello"));
+  }
+  // Page 0, and the new page evicted to read it back, were written.
+  EXPECT_EQ(2, disk_manager->GetNumWrites());
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+}  // namespace bustub
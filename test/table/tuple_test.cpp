@@ -10,10 +10,16 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <fcntl.h>
+#include <unistd.h>
 #include <algorithm>
+#include <atomic>
+#include <chrono>  // NOLINT
 #include <cstdio>
 #include <iostream>
+#include <memory>
 #include <string>
+#include <thread>  // NOLINT
 #include <vector>
 
 #include "buffer/buffer_pool_manager.h"
@@ -71,4 +77,148 @@ TEST(TupleTest, DISABLED_TableHeapTest) {
   delete disk_manager;
 }
 
+// NOLINTNEXTLINE
+TEST(TupleTest, ExtentAllocationTest) {
+  const std::string db_name = "test.db";
+  const int num_tables = 2;
+  const int num_tuples = 100;
+  const size_t extent_size = 8;
+  Column col1{"a", TypeId::INTEGER};
+  Column col2{"b", TypeId::VARCHAR, 1000};
+  Schema schema{{col1, col2}};
+
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(64, disk_manager);
+  Transaction txn(0);
+  std::vector<std::unique_ptr<TableHeap>> tables;
+  for (int i = 0; i < num_tables; ++i) {
+    tables.push_back(std::make_unique<TableHeap>(bpm, nullptr, nullptr, &txn, extent_size));
+  }
+
+  // Scenario: Tables growing in turns each get their pages in extents of consecutive pages.
+  for (int j = 0; j < num_tuples; ++j) {
+    for (int i = 0; i < num_tables; ++i) {
+      Tuple tuple({Value(TypeId::INTEGER, j), Value(TypeId::VARCHAR, std::string(900, 'a' + i))}, &schema);
+      RID rid;
+      ASSERT_TRUE(tables[i]->InsertTuple(tuple, &rid, &txn));
+    }
+  }
+  size_t num_unused_pages = 0;
+  for (auto &table : tables) {
+    std::vector<page_id_t> page_ids;
+    for (page_id_t page_id = table->GetFirstPageId(); page_id != INVALID_PAGE_ID;
+         page_id = bpm->FetchPageRead(page_id).As<TablePage>()->GetNextPageId()) {
+      page_ids.push_back(page_id);
+    }
+    ASSERT_GT(page_ids.size(), 2 * extent_size);
+    for (size_t i = 0; i < page_ids.size(); ++i) {
+      size_t extent_start = i - i % extent_size;
+      EXPECT_EQ(page_ids[extent_start] + static_cast<page_id_t>(i % extent_size), page_ids[i]) << "page " << i;
+      EXPECT_EQ(0, page_ids[extent_start] % static_cast<page_id_t>(extent_size)) << "page " << i;
+    }
+    num_unused_pages += (extent_size - page_ids.size() % extent_size) % extent_size;
+  }
+
+  // Scenario: The pages of the last extents the tables did not use are given back once the tables are gone.
+  EXPECT_EQ(0, disk_manager->GetNumFreePages());
+  tables.clear();
+  EXPECT_EQ(num_unused_pages, static_cast<size_t>(disk_manager->GetNumFreePages()));
+
+  disk_manager->ShutDown();
+  remove(db_name.c_str());
+  delete bpm;
+  delete disk_manager;
+}
+
+// A benchmark, run with --gtest_also_run_disabled_tests.
+// NOLINTNEXTLINE
+TEST(TupleTest, DISABLED_ExtentScanBenchmarkTest) {
+  const std::string db_name = "test.db";
+  const int num_tables = 4;
+  const int num_tuples = 2048;
+  Column col1{"a", TypeId::INTEGER};
+  Column col2{"b", TypeId::VARCHAR, 1000};
+  Schema schema{{col1, col2}};
+
+  // Scenario: Tables filled by concurrent inserts, with pages allocated one at a time or in extents, then one of them
+  // scanned with a cold page cache. Logging is off, the tables need neither a lock manager nor a log manager.
+  for (size_t extent_size : {size_t{1}, static_cast<size_t>(EXTENT_SIZE)}) {
+    remove(db_name.c_str());
+    auto *disk_manager = new DiskManager(db_name);
+    auto *bpm = new BufferPoolManager(2048, disk_manager);
+    Transaction txn(0);
+    std::vector<std::unique_ptr<TableHeap>> tables;
+    for (int i = 0; i < num_tables; ++i) {
+      tables.push_back(std::make_unique<TableHeap>(bpm, nullptr, nullptr, &txn, extent_size));
+    }
+    std::vector<std::thread> threads;
+    std::atomic<int> num_started{0};
+    for (int i = 0; i < num_tables; ++i) {
+      threads.emplace_back([&schema, &tables, &num_started, i] {
+        Transaction insert_txn(i + 1);
+        // All threads insert at once and take turns after every insert, so that the tables grow at the same time even
+        // on a single core.
+        num_started++;
+        while (num_started < num_tables) {
+          std::this_thread::yield();
+        }
+        for (int j = 0; j < num_tuples; ++j) {
+          Tuple tuple({Value(TypeId::INTEGER, j), Value(TypeId::VARCHAR, std::string(900, 'a' + i))}, &schema);
+          RID rid;
+          EXPECT_TRUE(tables[i]->InsertTuple(tuple, &rid, &insert_txn));
+          std::this_thread::yield();
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+
+    // Count the pages of the tables, and how often the next page of a table is not the next page of the file.
+    int num_pages = 0;
+    int num_jumps = 0;
+    page_id_t first_page_id = tables[0]->GetFirstPageId();
+    for (auto &table : tables) {
+      for (page_id_t page_id = table->GetFirstPageId(); page_id != INVALID_PAGE_ID;) {
+        page_id_t next_page_id = bpm->FetchPageRead(page_id).As<TablePage>()->GetNextPageId();
+        num_pages++;
+        num_jumps += next_page_id != INVALID_PAGE_ID && next_page_id != page_id + 1 ? 1 : 0;
+        page_id = next_page_id;
+      }
+    }
+    tables.clear();
+    bpm->FlushAllPages();
+    disk_manager->Sync();
+    delete bpm;
+    int fd = open(db_name.c_str(), O_RDONLY);
+    ASSERT_GE(fd, 0);
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    close(fd);
+
+    bpm = new BufferPoolManager(64, disk_manager);
+    Transaction scan_txn(num_tables + 1);
+    auto table = std::make_unique<TableHeap>(bpm, nullptr, nullptr, first_page_id);
+    int num_scanned = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (auto itr = table->Begin(&scan_txn); itr != table->End(); ++itr) {
+      num_scanned++;
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    EXPECT_EQ(num_tuples, num_scanned);
+    std::cout << (extent_size == 1 ? "page at a time" : "extents") << ": " << num_jumps << " jumps in " << num_pages
+              << " pages, " << static_cast<int64_t>(num_pages / num_tables / elapsed.count())
+              << " pages scanned per second" << std::endl;
+    if (extent_size > 1) {
+      EXPECT_LT(num_jumps, num_pages / 8);
+    }
+
+    table.reset();
+    disk_manager->ShutDown();
+    remove(db_name.c_str());
+    delete bpm;
+    delete disk_manager;
+  }
+}
+
 }  // namespace bustub